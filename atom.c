@@ -0,0 +1,249 @@
+#include "atom.h"
+
+#include "log.h"
+
+#include "hashers/wyhash.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ATOM_MINIMUM_SIZE 64
+#define ATOM_GROWTH_LOAD_FACTOR 0.5
+
+static logctx *logger = NULL;
+
+/* slots hold the atoms by hash, atoms is indexed by id */
+static atom **slots = NULL;
+static size_t slotssize = 0;
+
+static atom **atoms = NULL;
+static size_t atomslength = 0;
+static size_t atomssize = 0;
+
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+
+static atom *find_atom(uint64_t hash, size_t size, const char *string){
+    if (!slots){
+        return NULL;
+    }
+
+    size_t mask = slotssize - 1;
+
+    for (size_t index = hash & mask; slots[index]; index = (index + 1) & mask){
+        const atom *a = slots[index];
+
+        if (a->hash == hash && a->size == size && !memcmp(a->string, string, size)){
+            return slots[index];
+        }
+    }
+
+    return NULL;
+}
+
+static void insert_slot(atom **table, size_t size, atom *a){
+    size_t mask = size - 1;
+    size_t index = a->hash & mask;
+
+    while (table[index]){
+        index = (index + 1) & mask;
+    }
+
+    table[index] = a;
+}
+
+static bool check_availability(void){
+    if (atomslength == atomssize){
+        size_t size = atomssize ? atomssize << 1 : ATOM_MINIMUM_SIZE;
+        atom **tmp = realloc(atoms, size * sizeof(*atoms));
+
+        if (!tmp){
+            log_write(
+                logger,
+                LOG_ERROR,
+                "[%s] check_availability() - atoms realloc failed\n",
+                __FILE__
+            );
+
+            return false;
+        }
+
+        atoms = tmp;
+        atomssize = size;
+    }
+
+    if (atomslength + 1 > slotssize * ATOM_GROWTH_LOAD_FACTOR){
+        size_t size = slotssize ? slotssize << 1 : ATOM_MINIMUM_SIZE;
+        atom **table = calloc(size, sizeof(*table));
+
+        if (!table){
+            log_write(
+                logger,
+                LOG_ERROR,
+                "[%s] check_availability() - slots alloc failed\n",
+                __FILE__
+            );
+
+            return false;
+        }
+
+        for (size_t index = 0; index < atomslength; ++index){
+            insert_slot(table, size, atoms[index]);
+        }
+
+        free(slots);
+
+        slots = table;
+        slotssize = size;
+    }
+
+    return true;
+}
+
+const atom *atom_intern(size_t size, const char *string){
+    if (!string){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] atom_intern() - string is NULL\n",
+            __FILE__
+        );
+
+        return NULL;
+    }
+
+    if (size > ATOM_MAXIMUM_SIZE){
+        log_write(
+            logger,
+            LOG_DEBUG,
+            "[%s] atom_intern() - string is too long to intern\n",
+            __FILE__
+        );
+
+        return NULL;
+    }
+
+    uint64_t hash = wyhash(string, size, ATOM_HASH_SEED);
+
+    pthread_mutex_lock(&lock);
+
+    atom *a = find_atom(hash, size, string);
+
+    if (a){
+        pthread_mutex_unlock(&lock);
+
+        return a;
+    }
+
+    if (atomslength >= ATOM_MAXIMUM_LENGTH){
+        pthread_mutex_unlock(&lock);
+
+        log_write(
+            logger,
+            LOG_DEBUG,
+            "[%s] atom_intern() - atom table is full\n",
+            __FILE__
+        );
+
+        return NULL;
+    }
+
+    if (!check_availability()){
+        log_write(
+            logger,
+            LOG_ERROR,
+            "[%s] atom_intern() - check_availability call failed\n",
+            __FILE__
+        );
+
+        pthread_mutex_unlock(&lock);
+
+        return NULL;
+    }
+
+    a = malloc(sizeof(*a) + size + 1);
+
+    if (!a){
+        log_write(
+            logger,
+            LOG_ERROR,
+            "[%s] atom_intern() - atom alloc failed\n",
+            __FILE__
+        );
+
+        pthread_mutex_unlock(&lock);
+
+        return NULL;
+    }
+
+    a->hash = hash;
+    a->id = atomslength;
+    a->size = size;
+
+    memcpy(a->string, string, size);
+    a->string[size] = '\0';
+
+    atoms[atomslength++] = a;
+    insert_slot(slots, slotssize, a);
+
+    pthread_mutex_unlock(&lock);
+
+    return a;
+}
+
+const atom *atom_find(size_t size, const char *string){
+    if (!string){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] atom_find() - string is NULL\n",
+            __FILE__
+        );
+
+        return NULL;
+    }
+
+    uint64_t hash = wyhash(string, size, ATOM_HASH_SEED);
+
+    pthread_mutex_lock(&lock);
+
+    const atom *a = find_atom(hash, size, string);
+
+    pthread_mutex_unlock(&lock);
+
+    return a;
+}
+
+const atom *atom_get(uint32_t id){
+    const atom *a = NULL;
+
+    pthread_mutex_lock(&lock);
+
+    if (id < atomslength){
+        a = atoms[id];
+    }
+
+    pthread_mutex_unlock(&lock);
+
+    if (!a){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] atom_get() - id out of range\n",
+            __FILE__
+        );
+    }
+
+    return a;
+}
+
+size_t atom_get_length(void){
+    pthread_mutex_lock(&lock);
+
+    size_t length = atomslength;
+
+    pthread_mutex_unlock(&lock);
+
+    return length;
+}
@@ -0,0 +1,40 @@
+#ifndef ATOM_H
+#define ATOM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * process wide string interning. equal strings intern to the same
+ * atom so they can be compared by pointer (or id) and their hash is
+ * computed once. atoms are never freed and every intern takes one
+ * process wide lock -- meant for a small, repeating vocabulary (field,
+ * column and header names). the table is bounded so names that come
+ * from input can't grow it forever, atom_intern returns NULL for strings
+ * longer than ATOM_MAXIMUM_SIZE and once ATOM_MAXIMUM_LENGTH atoms
+ * exist. safe to use from multiple threads
+ */
+
+#define ATOM_MAXIMUM_LENGTH 4096
+#define ATOM_MAXIMUM_SIZE 64
+
+/* atoms are hashed with wyhash and this seed (see map_options.atoms) */
+#define ATOM_HASH_SEED 0x2D358DCCAA6C78A5ULL
+
+typedef struct atom {
+    uint64_t hash;
+    uint32_t id;
+    size_t size;
+
+    /* always null terminated */
+    char string[];
+} atom;
+
+const atom *atom_intern(size_t, const char *);
+const atom *atom_find(size_t, const char *);
+const atom *atom_get(uint32_t);
+
+size_t atom_get_length(void);
+
+#endif
@@ -0,0 +1,144 @@
+/*
+ * cmap thread scaling -- 90% get / 10% set over 100k string keys,
+ * split evenly over 1 to 64 threads, against one map behind a single
+ * mutex. build from the repository root:
+ *
+ *     cc -std=c18 -O2 -I. bench/cmap_scaling.c cmap.c map.c list.c \
+ *         str.c log.c atom.c filter.c hashers/murmur3.c \
+ *         hashers/spooky.c hashers/wyhash.c -o cmap_scaling -lpthread
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include "cmap.h"
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_KEYS 100000
+#define BENCH_OPS 4000000
+#define BENCH_MAX_THREADS 64
+#define BENCH_KEY_LENGTH 16
+
+typedef struct bench_worker {
+    pthread_t thread;
+    uint64_t seed;
+    size_t ops;
+    bool sharded;
+    int64_t sum;
+} bench_worker;
+
+static char keys[BENCH_KEYS][BENCH_KEY_LENGTH];
+
+static cmap *sharded = NULL;
+static map *single = NULL;
+static pthread_mutex_t singlelock = PTHREAD_MUTEX_INITIALIZER;
+
+static double now(void){
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+
+    return (double)t.tv_sec + (double)t.tv_nsec * 1e-9;
+}
+
+static uint64_t next_random(uint64_t *state){
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+
+    return *state;
+}
+
+static void *work(void *arg){
+    bench_worker *w = arg;
+
+    for (size_t op = 0; op < w->ops; ++op){
+        uint64_t r = next_random(&w->seed);
+        const char *key = keys[r % BENCH_KEYS];
+        size_t size = strlen(key);
+
+        if (r % 10 == 0){
+            int64_t value = (int64_t)op;
+            map_item k = {.type = M_TYPE_STRING, .size = size, .data_copy = key};
+            map_item v = {.type = M_TYPE_INT, .size = sizeof(value), .data_copy = &value};
+
+            if (w->sharded){
+                cmap_set(sharded, &k, &v);
+            }
+            else {
+                pthread_mutex_lock(&singlelock);
+                map_set(single, &k, &v);
+                pthread_mutex_unlock(&singlelock);
+            }
+        }
+        else if (w->sharded){
+            w->sum += cmap_get_int(sharded, size, key);
+        }
+        else {
+            pthread_mutex_lock(&singlelock);
+            w->sum += map_get_int(single, size, key);
+            pthread_mutex_unlock(&singlelock);
+        }
+    }
+
+    return NULL;
+}
+
+/* million ops per second */
+static double run(size_t threads, bool shard){
+    bench_worker workers[BENCH_MAX_THREADS];
+    double start = now();
+
+    for (size_t index = 0; index < threads; ++index){
+        workers[index].seed = index * 7919 + 1;
+        workers[index].ops = BENCH_OPS / threads;
+        workers[index].sharded = shard;
+        workers[index].sum = 0;
+
+        pthread_create(&workers[index].thread, NULL, work, workers + index);
+    }
+
+    for (size_t index = 0; index < threads; ++index){
+        pthread_join(workers[index].thread, NULL);
+    }
+
+    return (double)BENCH_OPS / (now() - start) / 1e6;
+}
+
+int main(void){
+    sharded = cmap_init(0);
+    single = map_init();
+
+    if (!sharded || !single){
+        fprintf(stderr, "map initialization failed\n");
+
+        return EXIT_FAILURE;
+    }
+
+    for (size_t index = 0; index < BENCH_KEYS; ++index){
+        snprintf(keys[index], BENCH_KEY_LENGTH, "key:%zu", index);
+
+        int64_t value = (int64_t)index;
+        map_item k = {.type = M_TYPE_STRING, .size = strlen(keys[index]), .data_copy = keys[index]};
+        map_item v = {.type = M_TYPE_INT, .size = sizeof(value), .data_copy = &value};
+
+        cmap_set(sharded, &k, &v);
+        map_set(single, &k, &v);
+    }
+
+    for (size_t threads = 1; threads <= BENCH_MAX_THREADS; threads *= 2){
+        double mutex = run(threads, false);
+        double shard = run(threads, true);
+
+        printf("%2zu threads: mutex map %6.2f Mops/s, cmap %6.2f Mops/s\n", threads, mutex, shard);
+    }
+
+    cmap_free(sharded);
+    map_free(single);
+
+    return EXIT_SUCCESS;
+}
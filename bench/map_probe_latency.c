@@ -0,0 +1,183 @@
+/*
+ * map lookup latency by probe mode -- 100k uint64 keys, then 400k
+ * remove + insert pairs so the table carries deletes, then timed hits
+ * and misses. prints the probe distances from map_stats, then p50 /
+ * p99 / max per lookup. build from the repository root:
+ *
+ *     cc -std=c18 -O2 -I. bench/map_probe_latency.c map.c list.c \
+ *         str.c log.c atom.c filter.c hashers/murmur3.c \
+ *         hashers/spooky.c hashers/wyhash.c -o map_probe_latency
+ *
+ * probe distances are counted in groups for group probing and in slots
+ * for robin hood, see mstats. one x86_64 core, p50 / p99:
+ *
+ *     baseline (4955c65)  hit  ~430 /  ~950 ns  miss ~1.1 / ~5.7 ms
+ *     group               hit  ~265 /  ~530 ns  miss  ~76 / ~335 ns
+ *     robin hood          hit  ~260 /  ~620 ns  miss ~118 / ~405 ns
+ *
+ * the baseline has no probe modes, map_init_ex or map_stats, so it was
+ * timed with the lookup part of this file, stub logging and 2000
+ * lookups -- its misses probe through the deletes across most of the table
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include "map.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define BENCH_KEYS 100000
+#define BENCH_CHURN 400000
+#define BENCH_LOOKUPS 1000000
+
+static uint64_t live[BENCH_KEYS];
+static uint64_t samples[BENCH_LOOKUPS];
+
+static uint64_t now(void){
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+
+    return (uint64_t)t.tv_sec * 1000000000 + (uint64_t)t.tv_nsec;
+}
+
+static uint64_t next_random(uint64_t *state){
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+
+    return *state;
+}
+
+static int compare(const void *a, const void *b){
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+
+    return (x > y) - (x < y);
+}
+
+static bool insert(map *m, uint64_t key){
+    map_item k = {.type = M_TYPE_UINT, .size = sizeof(key), .data_copy = &key};
+    map_item v = {.type = M_TYPE_UINT, .size = sizeof(key), .data_copy = &key};
+
+    return map_set(m, &k, &v);
+}
+
+/* the bucket holding the given share of entries, the last bucket is open ended */
+static size_t percentile(const mstats *stats, size_t length, size_t percent){
+    size_t seen = 0;
+
+    for (size_t index = 0; index < MAP_STATS_PROBES; ++index){
+        seen += stats->probes[index];
+
+        if (seen * 100 >= length * percent){
+            return index;
+        }
+    }
+
+    return MAP_STATS_PROBES - 1;
+}
+
+static void report_probes(map *m, const char *name){
+    mstats stats;
+
+    if (!map_stats(m, &stats)){
+        fprintf(stderr, "map_stats call failed\n");
+
+        return;
+    }
+
+    size_t length = map_get_length(m);
+
+    printf(
+        "%-10s probe %s  p50 %zu  p99 %zu  max %zu  mean %.2f\n",
+        name,
+        m->probe == M_PROBE_GROUP ? "groups" : "slots ",
+        percentile(&stats, length, 50),
+        percentile(&stats, length, 99),
+        stats.maxprobe,
+        stats.meanprobe
+    );
+}
+
+/* even keys are stored, odd keys never are, so misses stay misses */
+static void report(map *m, const char *name, bool hit, uint64_t *state){
+    uint64_t sum = 0;
+
+    for (size_t index = 0; index < BENCH_LOOKUPS; ++index){
+        uint64_t key = live[next_random(state) % BENCH_KEYS] | !hit;
+        uint64_t start = now();
+
+        sum += map_contains(m, sizeof(key), &key);
+
+        samples[index] = now() - start;
+    }
+
+    qsort(samples, BENCH_LOOKUPS, sizeof(*samples), compare);
+
+    printf(
+        "%-10s %s  p50 %4llu ns  p99 %5llu ns  max %7llu ns  (%llu found)\n",
+        name,
+        hit ? "hit " : "miss",
+        (unsigned long long)samples[BENCH_LOOKUPS / 2],
+        (unsigned long long)samples[BENCH_LOOKUPS / 100 * 99],
+        (unsigned long long)samples[BENCH_LOOKUPS - 1],
+        (unsigned long long)sum
+    );
+}
+
+static bool run(mprobe probe, const char *name){
+    map_options options = {.probe = probe};
+    map *m = map_init_ex(&options);
+    uint64_t state = 88172645463325252ULL;
+
+    if (!m){
+        fprintf(stderr, "map_init_ex call failed\n");
+
+        return false;
+    }
+
+    for (size_t index = 0; index < BENCH_KEYS; ++index){
+        live[index] = next_random(&state) << 1;
+
+        if (!insert(m, live[index])){
+            fprintf(stderr, "insert failed\n");
+            map_free(m);
+
+            return false;
+        }
+    }
+
+    for (size_t index = 0; index < BENCH_CHURN; ++index){
+        size_t victim = next_random(&state) % BENCH_KEYS;
+
+        map_remove(m, sizeof(live[victim]), live + victim);
+
+        live[victim] = next_random(&state) << 1;
+
+        if (!insert(m, live[victim])){
+            fprintf(stderr, "insert failed\n");
+            map_free(m);
+
+            return false;
+        }
+    }
+
+    report_probes(m, name);
+    report(m, name, true, &state);
+    report(m, name, false, &state);
+
+    map_free(m);
+
+    return true;
+}
+
+int main(void){
+    if (!run(M_PROBE_GROUP, "group") || !run(M_PROBE_ROBIN_HOOD, "robin hood")){
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,810 @@
+#include "cache.h"
+
+#include "log.h"
+#include "map_item.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CACHE_MINIMUM_SIZE 8
+#define CACHE_NONE UINT32_MAX
+
+/*
+ * tinylfu frequency sketch -- a count-min sketch of 4 bit counters,
+ * a few counters per cached entry. counters are halved every sample
+ * (capacity * factor) additions so old popularity fades
+ */
+#define CACHE_SKETCH_ROWS 4
+#define CACHE_SKETCH_COUNTERS 4
+#define CACHE_SKETCH_MINIMUM_WIDTH 64
+#define CACHE_SKETCH_DEFAULT_CAPACITY 1024
+#define CACHE_SKETCH_MAXIMUM 15
+#define CACHE_SKETCH_SAMPLE_FACTOR 10
+
+static logctx *logger = NULL;
+
+static const uint64_t sketchseeds[CACHE_SKETCH_ROWS] = {
+    0x9E3779B97F4A7C15ULL,
+    0xC2B2AE3D27D4EB4FULL,
+    0x165667B19E3779F9ULL,
+    0xD6E8FEB86659FD93ULL
+};
+
+typedef struct cache_entry {
+    uint64_t hash;
+    map_item key;
+    map_item value;
+    uint32_t prev;
+    uint32_t next;
+} cache_entry;
+
+typedef struct cache_sketch {
+    uint8_t *counters;
+    unsigned bits;
+    size_t additions;
+    size_t sample;
+} cache_sketch;
+
+static size_t sketch_width(const cache_sketch *s){
+    return (size_t)1 << s->bits;
+}
+
+static size_t sketch_index(const cache_sketch *s, size_t row, uint64_t hash){
+    return row * sketch_width(s) + ((hash * sketchseeds[row]) >> (64 - s->bits));
+}
+
+static cache_sketch *sketch_init(size_t capacity){
+    cache_sketch *s = malloc(sizeof(*s));
+
+    if (!s){
+        return NULL;
+    }
+
+    if (!capacity){
+        capacity = CACHE_SKETCH_DEFAULT_CAPACITY;
+    }
+
+    size_t width = CACHE_SKETCH_MINIMUM_WIDTH;
+
+    while (width < capacity * CACHE_SKETCH_COUNTERS){
+        width <<= 1;
+    }
+
+    s->bits = (unsigned)__builtin_ctzll(width);
+    s->additions = 0;
+    s->sample = capacity * CACHE_SKETCH_SAMPLE_FACTOR;
+    s->counters = calloc(CACHE_SKETCH_ROWS * width, sizeof(*s->counters));
+
+    if (!s->counters){
+        free(s);
+
+        return NULL;
+    }
+
+    return s;
+}
+
+static void sketch_free(cache_sketch *s){
+    if (!s){
+        return;
+    }
+
+    free(s->counters);
+    free(s);
+}
+
+static void sketch_add(cache_sketch *s, uint64_t hash){
+    for (size_t row = 0; row < CACHE_SKETCH_ROWS; ++row){
+        uint8_t *counter = s->counters + sketch_index(s, row, hash);
+
+        if (*counter < CACHE_SKETCH_MAXIMUM){
+            ++*counter;
+        }
+    }
+
+    if (++s->additions < s->sample){
+        return;
+    }
+
+    for (size_t index = 0; index < CACHE_SKETCH_ROWS * sketch_width(s); ++index){
+        s->counters[index] >>= 1;
+    }
+
+    s->additions >>= 1;
+}
+
+static uint8_t sketch_estimate(const cache_sketch *s, uint64_t hash){
+    uint8_t estimate = CACHE_SKETCH_MAXIMUM;
+
+    for (size_t row = 0; row < CACHE_SKETCH_ROWS; ++row){
+        uint8_t counter = s->counters[sketch_index(s, row, hash)];
+
+        if (counter < estimate){
+            estimate = counter;
+        }
+    }
+
+    return estimate;
+}
+
+static size_t entry_bytes(const cache_entry *e){
+    return e->key.size + e->value.size;
+}
+
+static void entry_unlink(cache *c, uint32_t position){
+    cache_entry *e = c->entries + position;
+
+    if (e->prev != CACHE_NONE){
+        c->entries[e->prev].next = e->next;
+    }
+    else {
+        c->head = e->next;
+    }
+
+    if (e->next != CACHE_NONE){
+        c->entries[e->next].prev = e->prev;
+    }
+    else {
+        c->tail = e->prev;
+    }
+}
+
+static void entry_push_front(cache *c, uint32_t position){
+    cache_entry *e = c->entries + position;
+
+    e->prev = CACHE_NONE;
+    e->next = c->head;
+
+    if (c->head != CACHE_NONE){
+        c->entries[c->head].prev = position;
+    }
+    else {
+        c->tail = position;
+    }
+
+    c->head = position;
+}
+
+static uint32_t entry_alloc(cache *c){
+    if (c->freelist != CACHE_NONE){
+        uint32_t position = c->freelist;
+
+        c->freelist = c->entries[position].next;
+
+        return position;
+    }
+
+    if (c->entrieslength == c->entriessize){
+        size_t size = c->entriessize << 1;
+
+        if (size >= CACHE_NONE){
+            log_write(
+                logger,
+                LOG_ERROR,
+                "[%s] entry_alloc() - cache is too large\n",
+                __FILE__
+            );
+
+            return CACHE_NONE;
+        }
+
+        cache_entry *entries = realloc(c->entries, size * sizeof(*entries));
+
+        if (!entries){
+            log_write(
+                logger,
+                LOG_ERROR,
+                "[%s] entry_alloc() - entries realloc failed\n",
+                __FILE__
+            );
+
+            return CACHE_NONE;
+        }
+
+        c->entries = entries;
+        c->entriessize = size;
+    }
+
+    return c->entrieslength++;
+}
+
+/* drops the entry from the index and the recency list, frees it */
+static void entry_release(cache *c, uint32_t position, bool evicted){
+    cache_entry *e = c->entries + position;
+
+    if (evicted){
+        if (c->options.evict){
+            c->options.evict(&e->key, &e->value, c->options.evictarg);
+        }
+
+        ++c->stats.evictions;
+    }
+
+    map_remove(c->index, e->key.size, e->key.data);
+
+    entry_unlink(c, position);
+
+    c->bytes -= entry_bytes(e);
+    --c->length;
+
+    map_item_free(&e->key);
+    map_item_free(&e->value);
+
+    e->next = c->freelist;
+    c->freelist = position;
+}
+
+static bool over_capacity(const cache *c, size_t extra){
+    if (c->options.capacity && c->length + (extra ? 1 : 0) > c->options.capacity){
+        return true;
+    }
+
+    return c->options.capacitybytes && c->bytes + extra > c->options.capacitybytes;
+}
+
+/* evicts from the tail until the cache fits, never evicting keep */
+static void evict(cache *c, uint32_t keep){
+    while (over_capacity(c, 0) && c->tail != CACHE_NONE && c->tail != keep){
+        entry_release(c, c->tail, true);
+    }
+}
+
+static uint32_t find_entry(const cache *c, uint64_t hash, size_t size, const void *key){
+    const map_item *value = NULL;
+
+    if (map_try_get_prehashed(c->index, hash, size, key, M_TYPE_SIZE_T, &value) != M_STATUS_OK){
+        return CACHE_NONE;
+    }
+
+    return *(size_t *)map_item_get_data(value);
+}
+
+static cache_entry *get_entry(cache *c, size_t size, const void *key, mtype type){
+    if (!c){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] get_entry() - cache is NULL\n",
+            __FILE__
+        );
+
+        return NULL;
+    }
+    else if (!key){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] get_entry() - key is NULL\n",
+            __FILE__
+        );
+
+        return NULL;
+    }
+
+    uint64_t hash = map_hash_key(c->index, size, key);
+    uint32_t position = find_entry(c, hash, size, key);
+
+    if (c->sketch){
+        sketch_add(c->sketch, hash);
+    }
+
+    if (position == CACHE_NONE){
+        ++c->stats.misses;
+
+        log_write(
+            logger,
+            LOG_DEBUG,
+            "[%s] get_entry() - key does not exist\n",
+            __FILE__
+        );
+
+        return NULL;
+    }
+
+    ++c->stats.hits;
+
+    if (c->head != position){
+        entry_unlink(c, position);
+        entry_push_front(c, position);
+    }
+
+    cache_entry *e = c->entries + position;
+
+    if (type != M_TYPE_RESERVED_EMPTY && e->value.type != type){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] get_entry() - entry type does *not* match\n",
+            __FILE__
+        );
+    }
+
+    return e;
+}
+
+cache *cache_init(const cache_options *options){
+    if (!options){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] cache_init() - options is NULL\n",
+            __FILE__
+        );
+
+        return NULL;
+    }
+
+    cache *c = calloc(1, sizeof(*c));
+
+    if (!c){
+        log_write(
+            logger,
+            LOG_ERROR,
+            "[%s] cache_init() - cache alloc failed\n",
+            __FILE__
+        );
+
+        return NULL;
+    }
+
+    c->options = *options;
+    c->index = map_init();
+    c->entries = malloc(CACHE_MINIMUM_SIZE * sizeof(*c->entries));
+    c->sketch = options->tinylfu ? sketch_init(options->capacity) : NULL;
+
+    if (!c->index || !c->entries || (options->tinylfu && !c->sketch)){
+        log_write(
+            logger,
+            LOG_ERROR,
+            "[%s] cache_init() - initialization failed\n",
+            __FILE__
+        );
+
+        map_free(c->index);
+        free(c->entries);
+        sketch_free(c->sketch);
+        free(c);
+
+        return NULL;
+    }
+
+    c->entriessize = CACHE_MINIMUM_SIZE;
+    c->head = CACHE_NONE;
+    c->tail = CACHE_NONE;
+    c->freelist = CACHE_NONE;
+
+    return c;
+}
+
+size_t cache_get_length(const cache *c){
+    if (!c){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] cache_get_length() - cache is NULL\n",
+            __FILE__
+        );
+
+        return 0;
+    }
+
+    return c->length;
+}
+
+size_t cache_get_bytes(const cache *c){
+    if (!c){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] cache_get_bytes() - cache is NULL\n",
+            __FILE__
+        );
+
+        return 0;
+    }
+
+    return c->bytes;
+}
+
+bool cache_get_stats(const cache *c, cache_stats *stats){
+    if (!c || !stats){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] cache_get_stats() - cache or stats is NULL\n",
+            __FILE__
+        );
+
+        return false;
+    }
+
+    *stats = c->stats;
+
+    return true;
+}
+
+bool cache_contains(const cache *c, size_t size, const void *key){
+    if (!c || !key){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] cache_contains() - cache or key is NULL\n",
+            __FILE__
+        );
+
+        return false;
+    }
+
+    return find_entry(c, map_hash_key(c->index, size, key), size, key) != CACHE_NONE;
+}
+
+mtype cache_get_type(const cache *c, size_t size, const void *key){
+    if (!c || !key){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] cache_get_type() - cache or key is NULL\n",
+            __FILE__
+        );
+
+        return M_TYPE_RESERVED_ERROR;
+    }
+
+    uint32_t position = find_entry(c, map_hash_key(c->index, size, key), size, key);
+
+    if (position == CACHE_NONE){
+        return M_TYPE_RESERVED_ERROR;
+    }
+
+    return c->entries[position].value.type;
+}
+
+const map_item *cache_get(cache *c, size_t size, const void *key){
+    const cache_entry *e = get_entry(c, size, key, M_TYPE_RESERVED_EMPTY);
+
+    if (!e){
+        return NULL;
+    }
+
+    return &e->value;
+}
+
+bool cache_get_bool(cache *c, size_t size, const void *key){
+    const cache_entry *e = get_entry(c, size, key, M_TYPE_BOOL);
+
+    if (!e){
+        return false;
+    }
+
+    return *(bool *)e->value.data;
+}
+
+char cache_get_char(cache *c, size_t size, const void *key){
+    const cache_entry *e = get_entry(c, size, key, M_TYPE_CHAR);
+
+    if (!e){
+        return 0;
+    }
+
+    return *(char *)e->value.data;
+}
+
+double cache_get_double(cache *c, size_t size, const void *key){
+    const cache_entry *e = get_entry(c, size, key, M_TYPE_DOUBLE);
+
+    if (!e){
+        return 0.0;
+    }
+
+    return *(double *)e->value.data;
+}
+
+int64_t cache_get_int(cache *c, size_t size, const void *key){
+    const cache_entry *e = get_entry(c, size, key, M_TYPE_INT);
+
+    if (!e){
+        return 0;
+    }
+
+    return *(int64_t *)e->value.data;
+}
+
+uint64_t cache_get_uint(cache *c, size_t size, const void *key){
+    const cache_entry *e = get_entry(c, size, key, M_TYPE_UINT);
+
+    if (!e){
+        return 0;
+    }
+
+    return *(uint64_t *)e->value.data;
+}
+
+size_t cache_get_size_t(cache *c, size_t size, const void *key){
+    const cache_entry *e = get_entry(c, size, key, M_TYPE_SIZE_T);
+
+    if (!e){
+        return 0;
+    }
+
+    return *(size_t *)e->value.data;
+}
+
+/*
+ * READ WARNING FOR THESE FUNCTIONS IN HEADER FILE
+ */
+char *cache_get_string(cache *c, size_t size, const void *key){
+    const cache_entry *e = get_entry(c, size, key, M_TYPE_STRING);
+
+    if (!e){
+        return NULL;
+    }
+
+    return e->value.data;
+}
+
+list *cache_get_list(cache *c, size_t size, const void *key){
+    const cache_entry *e = get_entry(c, size, key, M_TYPE_LIST);
+
+    if (!e){
+        return NULL;
+    }
+
+    return e->value.data;
+}
+
+map *cache_get_map(cache *c, size_t size, const void *key){
+    const cache_entry *e = get_entry(c, size, key, M_TYPE_MAP);
+
+    if (!e){
+        return NULL;
+    }
+
+    return e->value.data;
+}
+
+void *cache_get_generic(cache *c, size_t size, const void *key){
+    const cache_entry *e = get_entry(c, size, key, M_TYPE_GENERIC);
+
+    if (!e){
+        return NULL;
+    }
+
+    return e->value.data;
+}
+
+bool cache_set(cache *c, const map_item *key, const map_item *value){
+    if (!c){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] cache_set() - cache is NULL\n",
+            __FILE__
+        );
+
+        return false;
+    }
+    else if (!key || !value){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] cache_set() - key or value is NULL\n",
+            __FILE__
+        );
+
+        return false;
+    }
+    else if (key->data){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] cache_set() - key will *always* be copied -- set key in data_copy instead\n",
+            __FILE__
+        );
+
+        return false;
+    }
+
+    uint64_t hash = map_hash_key(c->index, key->size, key->data_copy);
+    uint32_t position = find_entry(c, hash, key->size, key->data_copy);
+
+    if (c->sketch){
+        sketch_add(c->sketch, hash);
+    }
+
+    if (position != CACHE_NONE){
+        map_item tmp;
+
+        if (!map_item_init(&tmp, value)){
+            log_write(
+                logger,
+                LOG_ERROR,
+                "[%s] cache_set() - value initialization failed\n",
+                __FILE__
+            );
+
+            return false;
+        }
+
+        cache_entry *e = c->entries + position;
+
+        c->bytes -= entry_bytes(e);
+        map_item_free(&e->value);
+        e->value = tmp;
+        c->bytes += entry_bytes(e);
+
+        if (c->head != position){
+            entry_unlink(c, position);
+            entry_push_front(c, position);
+        }
+
+        evict(c, position);
+
+        return true;
+    }
+
+    if (c->sketch && c->tail != CACHE_NONE && over_capacity(c, key->size + value->size)){
+        /* admission -- only replace the victim with a more popular key */
+        if (sketch_estimate(c->sketch, hash) <= sketch_estimate(c->sketch, c->entries[c->tail].hash)){
+            if (value->data){
+                map_item tmp = *value;
+
+                map_item_free(&tmp);
+            }
+
+            ++c->stats.rejections;
+
+            return true;
+        }
+    }
+
+    position = entry_alloc(c);
+
+    if (position == CACHE_NONE){
+        log_write(
+            logger,
+            LOG_ERROR,
+            "[%s] cache_set() - entry_alloc call failed\n",
+            __FILE__
+        );
+
+        return false;
+    }
+
+    cache_entry *e = c->entries + position;
+
+    e->hash = hash;
+
+    if (!map_item_init(&e->key, key)){
+        log_write(
+            logger,
+            LOG_ERROR,
+            "[%s] cache_set() - key initialization failed\n",
+            __FILE__
+        );
+
+        e->next = c->freelist;
+        c->freelist = position;
+
+        return false;
+    }
+
+    if (!map_item_init(&e->value, value)){
+        log_write(
+            logger,
+            LOG_ERROR,
+            "[%s] cache_set() - value initialization failed\n",
+            __FILE__
+        );
+
+        map_item_free(&e->key);
+
+        e->next = c->freelist;
+        c->freelist = position;
+
+        return false;
+    }
+
+    size_t index = position;
+
+    map_item indexkey = {0};
+    indexkey.type = e->key.type;
+    indexkey.size = e->key.size;
+    indexkey.data = e->key.data;
+
+    map_item indexvalue = {0};
+    indexvalue.type = M_TYPE_SIZE_T;
+    indexvalue.size = sizeof(index);
+    indexvalue.data_copy = &index;
+
+    if (!map_set_borrowed(c->index, &indexkey, &indexvalue)){
+        log_write(
+            logger,
+            LOG_ERROR,
+            "[%s] cache_set() - map_set_borrowed call failed\n",
+            __FILE__
+        );
+
+        /* the caller keeps value->data on failure */
+        if (!value->data){
+            map_item_free(&e->value);
+        }
+
+        map_item_free(&e->key);
+
+        e->next = c->freelist;
+        c->freelist = position;
+
+        return false;
+    }
+
+    entry_push_front(c, position);
+
+    c->bytes += entry_bytes(e);
+    ++c->length;
+
+    evict(c, position);
+
+    return true;
+}
+
+void cache_remove(cache *c, size_t size, const void *key){
+    if (!c){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] cache_remove() - cache is NULL\n",
+            __FILE__
+        );
+
+        return;
+    }
+    else if (!key){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] cache_remove() - key is NULL\n",
+            __FILE__
+        );
+
+        return;
+    }
+
+    uint32_t position = find_entry(c, map_hash_key(c->index, size, key), size, key);
+
+    if (position == CACHE_NONE){
+        log_write(
+            logger,
+            LOG_DEBUG,
+            "[%s] cache_remove() - key does not exist\n",
+            __FILE__
+        );
+
+        return;
+    }
+
+    entry_release(c, position, false);
+}
+
+void cache_free(cache *c){
+    if (!c){
+        log_write(
+            logger,
+            LOG_DEBUG,
+            "[%s] cache_free() - cache is NULL\n",
+            __FILE__
+        );
+
+        return;
+    }
+
+    for (uint32_t position = c->head; position != CACHE_NONE; position = c->entries[position].next){
+        map_item_free(&c->entries[position].key);
+        map_item_free(&c->entries[position].value);
+    }
+
+    map_free(c->index);
+    free(c->entries);
+    sketch_free(c->sketch);
+    free(c);
+}
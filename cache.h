@@ -0,0 +1,103 @@
+#ifndef CACHE_H
+#define CACHE_H
+
+#include "map.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * bounded LRU cache. entries are kept in recency order, a hit moves
+ * the entry to the front without allocating and the least recently
+ * used entries are evicted from the tail once a capacity is exceeded.
+ * with tinylfu set a new key only gets in when it has been asked for
+ * more often than the entry it would evict (frequency sketch) --
+ * keeps one-off keys from flushing the cache
+ */
+
+typedef void (*cache_evict)(const map_item *, const map_item *, void *);
+
+typedef struct cache_options {
+    /* 0 is unlimited, at least one of them should be set */
+    size_t capacity;
+    size_t capacitybytes;
+
+    bool tinylfu;
+
+    /* called with the key and value of every evicted entry */
+    cache_evict evict;
+    void *evictarg;
+} cache_options;
+
+typedef struct cache_stats {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+    uint64_t rejections;
+} cache_stats;
+
+typedef struct cache_entry cache_entry;
+typedef struct cache_sketch cache_sketch;
+
+typedef struct cache {
+    cache_options options;
+
+    /* key -> position in entries, keys are borrowed from the entries */
+    map *index;
+
+    cache_entry *entries;
+    size_t entrieslength;
+    size_t entriessize;
+
+    /* recency list through entries, free entries are chained on freelist */
+    uint32_t head;
+    uint32_t tail;
+    uint32_t freelist;
+
+    size_t length;
+    size_t bytes;
+
+    cache_sketch *sketch;
+    cache_stats stats;
+} cache;
+
+cache *cache_init(const cache_options *);
+
+size_t cache_get_length(const cache *);
+size_t cache_get_bytes(const cache *);
+bool cache_get_stats(const cache *, cache_stats *);
+
+/* neither of these count as a use of the entry */
+bool cache_contains(const cache *, size_t, const void *);
+mtype cache_get_type(const cache *, size_t, const void *);
+
+/*
+ * lookups count a hit or miss and move the entry to the front.
+ * the value is only valid until the cache is next modified
+ */
+const map_item *cache_get(cache *, size_t, const void *);
+bool cache_get_bool(cache *, size_t, const void *);
+char cache_get_char(cache *, size_t, const void *);
+double cache_get_double(cache *, size_t, const void *);
+int64_t cache_get_int(cache *, size_t, const void *);
+uint64_t cache_get_uint(cache *, size_t, const void *);
+size_t cache_get_size_t(cache *, size_t, const void *);
+
+/* see the warning in map.h -- the same applies here */
+char *cache_get_string(cache *, size_t, const void *);
+list *cache_get_list(cache *, size_t, const void *);
+map *cache_get_map(cache *, size_t, const void *);
+void *cache_get_generic(cache *, size_t, const void *);
+
+/*
+ * same rules as map_set. a value turned away by tinylfu is freed
+ * right away (counted as a rejection) and true is still returned
+ */
+bool cache_set(cache *, const map_item *, const map_item *);
+
+/* explicit removals don't call the eviction callback */
+void cache_remove(cache *, size_t, const void *);
+void cache_free(cache *);
+
+#endif
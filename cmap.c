@@ -0,0 +1,492 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "cmap.h"
+
+#include "list.h"
+#include "log.h"
+#include "str.h"
+
+#include "hashers/wyhash.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* shards are padded to a cache line so their locks don't false share */
+#define CMAP_CACHE_LINE 64
+
+static logctx *logger = NULL;
+
+typedef struct cmap_shard {
+    _Alignas(CMAP_CACHE_LINE) pthread_rwlock_t lock;
+    map *m;
+    atomic_size_t length;
+} cmap_shard;
+
+static bool is_power_of_two(size_t number){
+    return number && !(number & (number - 1));
+}
+
+static uint64_t generate_hash(const cmap *c, size_t size, const void *key){
+    return wyhash(key, size, c->seed);
+}
+
+static cmap_shard *get_shard(cmap *c, uint64_t hash){
+    if (!c->bits){
+        return c->shards;
+    }
+
+    return c->shards + (hash >> (64 - c->bits));
+}
+
+/*
+ * looks key up under the shard's read lock and hands the stored value
+ * to copy (which runs while the lock is held). returns the lookup status
+ */
+static mstatus read_value(cmap *c, size_t size, const void *key, mtype type, void (*copy)(const map_item *, void *), void *out){
+    if (!c || !key){
+        return M_STATUS_INVALID;
+    }
+
+    uint64_t hash = generate_hash(c, size, key);
+    cmap_shard *shard = get_shard(c, hash);
+    const map_item *value = NULL;
+
+    pthread_rwlock_rdlock(&shard->lock);
+
+    mstatus status = map_try_get_prehashed(shard->m, hash, size, key, type, &value);
+
+    if (status == M_STATUS_OK && copy){
+        copy(value, out);
+    }
+
+    pthread_rwlock_unlock(&shard->lock);
+
+    return status;
+}
+
+/* only bad arguments are logged, getters on many threads would otherwise contend on it */
+static void log_status(mstatus status, const char *func){
+    if (status == M_STATUS_INVALID){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] %s() - cmap or key is NULL\n",
+            __FILE__,
+            func
+        );
+    }
+}
+
+static void copy_type(const map_item *value, void *out){
+    *(mtype *)out = value->type;
+}
+
+static void copy_bool(const map_item *value, void *out){
+    *(bool *)out = *(bool *)map_item_get_data(value);
+}
+
+static void copy_char(const map_item *value, void *out){
+    *(char *)out = *(char *)map_item_get_data(value);
+}
+
+static void copy_double(const map_item *value, void *out){
+    *(double *)out = *(double *)map_item_get_data(value);
+}
+
+static void copy_int(const map_item *value, void *out){
+    *(int64_t *)out = *(int64_t *)map_item_get_data(value);
+}
+
+static void copy_uint(const map_item *value, void *out){
+    *(uint64_t *)out = *(uint64_t *)map_item_get_data(value);
+}
+
+static void copy_size_t(const map_item *value, void *out){
+    *(size_t *)out = *(size_t *)map_item_get_data(value);
+}
+
+static void copy_string(const map_item *value, void *out){
+    char *string = malloc(value->size + 1);
+
+    if (string){
+        memcpy(string, value->data, value->size);
+
+        string[value->size] = '\0';
+    }
+
+    *(char **)out = string;
+}
+
+static void copy_list(const map_item *value, void *out){
+    *(list **)out = list_copy(value->data);
+}
+
+static void copy_map(const map_item *value, void *out){
+    *(map **)out = map_copy(value->data);
+}
+
+static void copy_pointer(const map_item *value, void *out){
+    *(void **)out = value->data;
+}
+
+cmap *cmap_init(size_t shards){
+    if (!shards){
+        shards = CMAP_DEFAULT_SHARDS;
+    }
+
+    if (!is_power_of_two(shards)){
+        log_write(
+            logger,
+            LOG_ERROR,
+            "[%s] cmap_init() - shards must be a power of 2\n",
+            __FILE__
+        );
+
+        return NULL;
+    }
+
+    cmap *c = malloc(sizeof(*c));
+
+    if (!c){
+        log_write(
+            logger,
+            LOG_ERROR,
+            "[%s] cmap_init() - cmap alloc failed\n",
+            __FILE__
+        );
+
+        return NULL;
+    }
+
+    c->shards = aligned_alloc(CMAP_CACHE_LINE, shards * sizeof(*c->shards));
+
+    if (!c->shards){
+        log_write(
+            logger,
+            LOG_ERROR,
+            "[%s] cmap_init() - shards alloc failed\n",
+            __FILE__
+        );
+
+        free(c);
+
+        return NULL;
+    }
+
+    c->shardslength = shards;
+    c->bits = __builtin_ctzll(shards);
+    c->seed = (uint64_t)&c;
+
+    /* shards hash like the cmap, so the hash picking a shard is reused inside it */
+    map_options options = {0};
+    options.hasher = map_hash_wyhash;
+
+    for (size_t index = 0; index < shards; ++index){
+        cmap_shard *shard = c->shards + index;
+
+        shard->m = map_init_ex(&options);
+
+        if (!shard->m || pthread_rwlock_init(&shard->lock, NULL)){
+            log_write(
+                logger,
+                LOG_ERROR,
+                "[%s] cmap_init() - shard initialization failed\n",
+                __FILE__
+            );
+
+            map_free(shard->m);
+
+            c->shardslength = index;
+            cmap_free(c);
+
+            return NULL;
+        }
+
+        shard->m->seed = c->seed;
+        atomic_init(&shard->length, 0);
+    }
+
+    return c;
+}
+
+size_t cmap_get_length(cmap *c){
+    if (!c){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] cmap_get_length() - cmap is NULL\n",
+            __FILE__
+        );
+
+        return 0;
+    }
+
+    size_t length = 0;
+
+    for (size_t index = 0; index < c->shardslength; ++index){
+        length += atomic_load_explicit(&c->shards[index].length, memory_order_relaxed);
+    }
+
+    return length;
+}
+
+size_t cmap_get_shards(cmap *c){
+    if (!c){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] cmap_get_shards() - cmap is NULL\n",
+            __FILE__
+        );
+
+        return 0;
+    }
+
+    return c->shardslength;
+}
+
+bool cmap_contains(cmap *c, size_t size, const void *key){
+    mstatus status = read_value(c, size, key, M_TYPE_RESERVED_EMPTY, NULL, NULL);
+
+    if (status == M_STATUS_INVALID){
+        log_status(status, __func__);
+    }
+
+    return status == M_STATUS_OK;
+}
+
+mtype cmap_get_type(cmap *c, size_t size, const void *key){
+    mtype type = M_TYPE_RESERVED_ERROR;
+    mstatus status = read_value(c, size, key, M_TYPE_RESERVED_EMPTY, copy_type, &type);
+
+    log_status(status, __func__);
+
+    return type;
+}
+
+bool cmap_get_bool(cmap *c, size_t size, const void *key){
+    bool value = false;
+    mstatus status = read_value(c, size, key, M_TYPE_BOOL, copy_bool, &value);
+
+    log_status(status, __func__);
+
+    return value;
+}
+
+char cmap_get_char(cmap *c, size_t size, const void *key){
+    char value = 0;
+    mstatus status = read_value(c, size, key, M_TYPE_CHAR, copy_char, &value);
+
+    log_status(status, __func__);
+
+    return value;
+}
+
+double cmap_get_double(cmap *c, size_t size, const void *key){
+    double value = 0.0;
+    mstatus status = read_value(c, size, key, M_TYPE_DOUBLE, copy_double, &value);
+
+    log_status(status, __func__);
+
+    return value;
+}
+
+int64_t cmap_get_int(cmap *c, size_t size, const void *key){
+    int64_t value = 0;
+    mstatus status = read_value(c, size, key, M_TYPE_INT, copy_int, &value);
+
+    log_status(status, __func__);
+
+    return value;
+}
+
+uint64_t cmap_get_uint(cmap *c, size_t size, const void *key){
+    uint64_t value = 0;
+    mstatus status = read_value(c, size, key, M_TYPE_UINT, copy_uint, &value);
+
+    log_status(status, __func__);
+
+    return value;
+}
+
+size_t cmap_get_size_t(cmap *c, size_t size, const void *key){
+    size_t value = 0;
+    mstatus status = read_value(c, size, key, M_TYPE_SIZE_T, copy_size_t, &value);
+
+    log_status(status, __func__);
+
+    return value;
+}
+
+char *cmap_get_string(cmap *c, size_t size, const void *key){
+    char *value = NULL;
+    mstatus status = read_value(c, size, key, M_TYPE_STRING, copy_string, &value);
+
+    log_status(status, __func__);
+
+    return value;
+}
+
+list *cmap_get_list(cmap *c, size_t size, const void *key){
+    list *value = NULL;
+    mstatus status = read_value(c, size, key, M_TYPE_LIST, copy_list, &value);
+
+    log_status(status, __func__);
+
+    return value;
+}
+
+map *cmap_get_map(cmap *c, size_t size, const void *key){
+    map *value = NULL;
+    mstatus status = read_value(c, size, key, M_TYPE_MAP, copy_map, &value);
+
+    log_status(status, __func__);
+
+    return value;
+}
+
+void *cmap_get_generic(cmap *c, size_t size, const void *key){
+    void *value = NULL;
+    mstatus status = read_value(c, size, key, M_TYPE_GENERIC, copy_pointer, &value);
+
+    log_status(status, __func__);
+
+    return value;
+}
+
+bool cmap_set(cmap *c, const map_item *key, const map_item *value){
+    if (!c){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] cmap_set() - cmap is NULL\n",
+            __FILE__
+        );
+
+        return false;
+    }
+    else if (!key || !key->data_copy){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] cmap_set() - key is NULL -- set key in data_copy\n",
+            __FILE__
+        );
+
+        return false;
+    }
+
+    uint64_t hash = generate_hash(c, key->size, key->data_copy);
+    cmap_shard *shard = get_shard(c, hash);
+
+    pthread_rwlock_wrlock(&shard->lock);
+
+    bool success = map_set_prehashed(shard->m, hash, key, value);
+
+    atomic_store_explicit(&shard->length, map_get_length(shard->m), memory_order_relaxed);
+
+    pthread_rwlock_unlock(&shard->lock);
+
+    if (!success){
+        log_write(
+            logger,
+            LOG_ERROR,
+            "[%s] cmap_set() - map_set_prehashed call failed\n",
+            __FILE__
+        );
+    }
+
+    return success;
+}
+
+void cmap_pop(cmap *c, size_t size, const void *key, map_item *value){
+    if (!c){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] cmap_pop() - cmap is NULL\n",
+            __FILE__
+        );
+
+        return;
+    }
+    else if (!key){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] cmap_pop() - key is NULL\n",
+            __FILE__
+        );
+
+        return;
+    }
+
+    uint64_t hash = generate_hash(c, size, key);
+    cmap_shard *shard = get_shard(c, hash);
+
+    pthread_rwlock_wrlock(&shard->lock);
+
+    map_pop_prehashed(shard->m, hash, size, key, value);
+
+    atomic_store_explicit(&shard->length, map_get_length(shard->m), memory_order_relaxed);
+
+    pthread_rwlock_unlock(&shard->lock);
+}
+
+void cmap_remove(cmap *c, size_t size, const void *key){
+    if (!c){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] cmap_remove() - cmap is NULL\n",
+            __FILE__
+        );
+
+        return;
+    }
+    else if (!key){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] cmap_remove() - key is NULL\n",
+            __FILE__
+        );
+
+        return;
+    }
+
+    uint64_t hash = generate_hash(c, size, key);
+    cmap_shard *shard = get_shard(c, hash);
+
+    pthread_rwlock_wrlock(&shard->lock);
+
+    map_remove_prehashed(shard->m, hash, size, key);
+
+    atomic_store_explicit(&shard->length, map_get_length(shard->m), memory_order_relaxed);
+
+    pthread_rwlock_unlock(&shard->lock);
+}
+
+void cmap_free(cmap *c){
+    if (!c){
+        log_write(
+            logger,
+            LOG_DEBUG,
+            "[%s] cmap_free() - cmap is NULL\n",
+            __FILE__
+        );
+
+        return;
+    }
+
+    for (size_t index = 0; index < c->shardslength; ++index){
+        pthread_rwlock_destroy(&c->shards[index].lock);
+        map_free(c->shards[index].m);
+    }
+
+    free(c->shards);
+    free(c);
+}
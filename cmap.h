@@ -0,0 +1,59 @@
+#ifndef CMAP_H
+#define CMAP_H
+
+#include "map.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * thread safe map. keys are spread over a power of 2 number of
+ * shards by the high bits of their hash, each shard is a map with its
+ * own reader/writer lock so threads only contend on the same shard
+ */
+
+/* used when cmap_init is given 0 shards */
+#define CMAP_DEFAULT_SHARDS 64
+
+typedef struct cmap_shard cmap_shard;
+
+typedef struct cmap {
+    cmap_shard *shards;
+    size_t shardslength;
+    unsigned bits;
+    uint64_t seed;
+} cmap;
+
+cmap *cmap_init(size_t);
+
+size_t cmap_get_length(cmap *);
+size_t cmap_get_shards(cmap *);
+
+/* a missing key or wrong type returns 0 / NULL without logging */
+bool cmap_contains(cmap *, size_t, const void *);
+mtype cmap_get_type(cmap *, size_t, const void *);
+bool cmap_get_bool(cmap *, size_t, const void *);
+char cmap_get_char(cmap *, size_t, const void *);
+double cmap_get_double(cmap *, size_t, const void *);
+int64_t cmap_get_int(cmap *, size_t, const void *);
+uint64_t cmap_get_uint(cmap *, size_t, const void *);
+size_t cmap_get_size_t(cmap *, size_t, const void *);
+
+/*
+ * unlike map these return copies made under the shard's lock --
+ * the caller owns them (free/list_free/map_free)
+ */
+char *cmap_get_string(cmap *, size_t, const void *);
+list *cmap_get_list(cmap *, size_t, const void *);
+map *cmap_get_map(cmap *, size_t, const void *);
+
+/* generic data can't be copied -- the caller has to synchronize its use */
+void *cmap_get_generic(cmap *, size_t, const void *);
+
+bool cmap_set(cmap *, const map_item *, const map_item *);
+void cmap_pop(cmap *, size_t, const void *, map_item *);
+void cmap_remove(cmap *, size_t, const void *);
+void cmap_free(cmap *);
+
+#endif
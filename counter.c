@@ -0,0 +1,706 @@
+#include "counter.h"
+
+#include "log.h"
+
+#include "hashers/wyhash.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define COUNTER_MINIMUM_SIZE 8
+
+/* slots are 8 bytes so a sparse table is cheap and keeps the runs short */
+#define COUNTER_GROWTH_LOAD_FACTOR 0.5
+
+/* every counter hashes the same way so counter_merge can reuse the hashes */
+#define COUNTER_HASH_SEED 0x9FB21C651E98DF25ULL
+
+#define COUNTER_EMPTY UINT32_MAX
+
+static logctx *logger = NULL;
+
+typedef struct counter_entry {
+    uint64_t hash;
+    uint64_t count;
+    uint64_t error;
+
+    size_t size;
+    void *key;
+
+    /* position in c->heap */
+    uint32_t heap;
+} counter_entry;
+
+/* the top half of the hash rejects most mismatches without touching the entry */
+typedef struct counter_slot {
+    uint32_t entry;
+    uint32_t tag;
+} counter_slot;
+
+static uint32_t hash_tag(uint64_t hash){
+    return (uint32_t)(hash >> 32);
+}
+
+static counter_slot *slots_init(size_t size){
+    counter_slot *slots = malloc(size * sizeof(*slots));
+
+    if (!slots){
+        return NULL;
+    }
+
+    for (size_t index = 0; index < size; ++index){
+        slots[index].entry = COUNTER_EMPTY;
+    }
+
+    return slots;
+}
+
+/* the entry for key, or COUNTER_EMPTY with *slot set to where it would go */
+static uint32_t find_entry(const counter *c, uint64_t hash, size_t size, const void *key, size_t *slot){
+    size_t mask = c->size - 1;
+    size_t index = hash & mask;
+    uint32_t tag = hash_tag(hash);
+
+    for (; c->slots[index].entry != COUNTER_EMPTY; index = (index + 1) & mask){
+        if (c->slots[index].tag != tag){
+            continue;
+        }
+
+        const counter_entry *e = c->entries + c->slots[index].entry;
+
+        if (e->hash == hash && e->size == size && !memcmp(e->key, key, size)){
+            *slot = index;
+
+            return c->slots[index].entry;
+        }
+    }
+
+    *slot = index;
+
+    return COUNTER_EMPTY;
+}
+
+static size_t free_slot(const counter *c, uint64_t hash){
+    size_t mask = c->size - 1;
+    size_t index = hash & mask;
+
+    while (c->slots[index].entry != COUNTER_EMPTY){
+        index = (index + 1) & mask;
+    }
+
+    return index;
+}
+
+/* backward shift -- later slots of the run move into the hole if that's no further from home */
+static void erase_slot(counter *c, size_t index){
+    size_t mask = c->size - 1;
+    size_t hole = index;
+
+    for (size_t next = (index + 1) & mask; c->slots[next].entry != COUNTER_EMPTY; next = (next + 1) & mask){
+        size_t home = c->entries[c->slots[next].entry].hash & mask;
+
+        if (((next - home) & mask) >= ((next - hole) & mask)){
+            c->slots[hole] = c->slots[next];
+
+            hole = next;
+        }
+    }
+
+    c->slots[hole].entry = COUNTER_EMPTY;
+}
+
+static bool table_resize(counter *c, size_t size){
+    counter_slot *slots = slots_init(size);
+
+    if (!slots){
+        log_write(
+            logger,
+            LOG_ERROR,
+            "[%s] table_resize() - slots alloc failed\n",
+            __FILE__
+        );
+
+        return false;
+    }
+
+    free(c->slots);
+
+    c->slots = slots;
+    c->size = size;
+
+    for (size_t index = 0; index < c->length; ++index){
+        size_t slot = free_slot(c, c->entries[index].hash);
+
+        c->slots[slot].entry = index;
+        c->slots[slot].tag = hash_tag(c->entries[index].hash);
+    }
+
+    return true;
+}
+
+static void heap_swap(counter *c, size_t a, size_t b){
+    uint32_t tmp = c->heap[a];
+
+    c->heap[a] = c->heap[b];
+    c->heap[b] = tmp;
+
+    c->entries[c->heap[a]].heap = a;
+    c->entries[c->heap[b]].heap = b;
+}
+
+static void heap_up(counter *c, size_t position){
+    while (position){
+        size_t parent = (position - 1) / 2;
+
+        if (c->entries[c->heap[parent]].count <= c->entries[c->heap[position]].count){
+            break;
+        }
+
+        heap_swap(c, parent, position);
+
+        position = parent;
+    }
+}
+
+static void heap_down(counter *c, size_t position){
+    for (;;){
+        size_t smallest = position;
+        size_t left = position * 2 + 1;
+        size_t right = left + 1;
+
+        if (left < c->length && c->entries[c->heap[left]].count < c->entries[c->heap[smallest]].count){
+            smallest = left;
+        }
+
+        if (right < c->length && c->entries[c->heap[right]].count < c->entries[c->heap[smallest]].count){
+            smallest = right;
+        }
+
+        if (smallest == position){
+            break;
+        }
+
+        heap_swap(c, position, smallest);
+
+        position = smallest;
+    }
+}
+
+static void *key_copy(size_t size, const void *key){
+    char *copy = malloc(size + 1);
+
+    if (!copy){
+        log_write(
+            logger,
+            LOG_ERROR,
+            "[%s] key_copy() - key alloc failed\n",
+            __FILE__
+        );
+
+        return NULL;
+    }
+
+    memcpy(copy, key, size);
+
+    copy[size] = '\0';
+
+    return copy;
+}
+
+/* space saving -- key takes over the entry with the lowest count and its key buffer */
+static bool replace_minimum(counter *c, uint64_t hash, size_t size, const void *key, uint64_t delta, uint64_t error){
+    counter_entry *e = c->entries + c->heap[0];
+    size_t slot;
+
+    find_entry(c, e->hash, e->size, e->key, &slot);
+    erase_slot(c, slot);
+
+    char *copy = realloc(e->key, size + 1);
+
+    if (!copy){
+        log_write(
+            logger,
+            LOG_ERROR,
+            "[%s] replace_minimum() - key realloc failed\n",
+            __FILE__
+        );
+
+        slot = free_slot(c, e->hash);
+
+        c->slots[slot].entry = c->heap[0];
+        c->slots[slot].tag = hash_tag(e->hash);
+
+        return false;
+    }
+
+    memcpy(copy, key, size);
+
+    copy[size] = '\0';
+
+    e->hash = hash;
+    e->size = size;
+    e->key = copy;
+    e->error = e->count + error;
+    e->count += delta;
+
+    slot = free_slot(c, hash);
+
+    c->slots[slot].entry = c->heap[0];
+    c->slots[slot].tag = hash_tag(hash);
+
+    heap_down(c, 0);
+
+    return true;
+}
+
+static bool insert_entry(counter *c, uint64_t hash, size_t size, const void *key, uint64_t delta, uint64_t error){
+    if (c->length >= COUNTER_EMPTY - 1){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] insert_entry() - too many keys for 32-bit entry indexes\n",
+            __FILE__
+        );
+
+        return false;
+    }
+
+    if ((double)(c->length + 1) / (double)c->size > COUNTER_GROWTH_LOAD_FACTOR && !table_resize(c, c->size << 1)){
+        log_write(
+            logger,
+            LOG_ERROR,
+            "[%s] insert_entry() - table_resize call failed\n",
+            __FILE__
+        );
+
+        return false;
+    }
+
+    if (c->length == c->entriessize){
+        counter_entry *entries = realloc(c->entries, (c->entriessize << 1) * sizeof(*entries));
+
+        if (!entries){
+            log_write(
+                logger,
+                LOG_ERROR,
+                "[%s] insert_entry() - entries realloc failed\n",
+                __FILE__
+            );
+
+            return false;
+        }
+
+        c->entries = entries;
+        c->entriessize <<= 1;
+    }
+
+    void *copy = key_copy(size, key);
+
+    if (!copy){
+        log_write(
+            logger,
+            LOG_ERROR,
+            "[%s] insert_entry() - key_copy call failed\n",
+            __FILE__
+        );
+
+        return false;
+    }
+
+    counter_entry *e = c->entries + c->length;
+
+    e->hash = hash;
+    e->count = delta;
+    e->error = error;
+    e->size = size;
+    e->key = copy;
+    e->heap = c->length;
+
+    size_t slot = free_slot(c, hash);
+
+    c->slots[slot].entry = c->length;
+    c->slots[slot].tag = hash_tag(hash);
+
+    if (c->heap){
+        c->heap[c->length] = c->length;
+    }
+
+    ++c->length;
+
+    if (c->heap){
+        heap_up(c, c->length - 1);
+    }
+
+    return true;
+}
+
+static bool add(counter *c, uint64_t hash, size_t size, const void *key, uint64_t delta, uint64_t error){
+    size_t slot;
+    uint32_t index = find_entry(c, hash, size, key, &slot);
+
+    if (index != COUNTER_EMPTY){
+        counter_entry *e = c->entries + index;
+
+        e->count += delta;
+        e->error += error;
+
+        if (c->heap){
+            heap_down(c, e->heap);
+        }
+    }
+    else if (c->capacity && c->length == c->capacity){
+        if (!replace_minimum(c, hash, size, key, delta, error)){
+            return false;
+        }
+    }
+    else if (!insert_entry(c, hash, size, key, delta, error)){
+        return false;
+    }
+
+    c->total += delta;
+
+    return true;
+}
+
+static void item_from_entry(counter_item *item, const counter_entry *e){
+    item->size = e->size;
+    item->key = e->key;
+    item->count = e->count;
+    item->error = e->error;
+}
+
+/* lower count ranks lower, ties go to the later entry */
+static bool ranks_below(const counter *c, uint32_t a, uint32_t b){
+    if (c->entries[a].count != c->entries[b].count){
+        return c->entries[a].count < c->entries[b].count;
+    }
+
+    return a > b;
+}
+
+static void rank_down(const counter *c, uint32_t *ranked, size_t length, size_t position){
+    for (;;){
+        size_t lowest = position;
+        size_t left = position * 2 + 1;
+        size_t right = left + 1;
+
+        if (left < length && ranks_below(c, ranked[left], ranked[lowest])){
+            lowest = left;
+        }
+
+        if (right < length && ranks_below(c, ranked[right], ranked[lowest])){
+            lowest = right;
+        }
+
+        if (lowest == position){
+            break;
+        }
+
+        uint32_t tmp = ranked[position];
+
+        ranked[position] = ranked[lowest];
+        ranked[lowest] = tmp;
+
+        position = lowest;
+    }
+}
+
+counter *counter_init(void){
+    return counter_init_ex(NULL);
+}
+
+counter *counter_init_ex(const counter_options *options){
+    size_t capacity = options ? options->capacity : 0;
+
+    if (capacity >= COUNTER_EMPTY - 1){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] counter_init_ex() - capacity is too large for 32-bit entry indexes\n",
+            __FILE__
+        );
+
+        return NULL;
+    }
+
+    counter *c = calloc(1, sizeof(*c));
+
+    if (!c){
+        log_write(
+            logger,
+            LOG_ERROR,
+            "[%s] counter_init_ex() - counter alloc failed\n",
+            __FILE__
+        );
+
+        return NULL;
+    }
+
+    /* space saving never grows -- everything is sized for capacity up front */
+    size_t size = COUNTER_MINIMUM_SIZE;
+
+    while (capacity && (double)capacity / (double)size > COUNTER_GROWTH_LOAD_FACTOR){
+        size <<= 1;
+    }
+
+    c->capacity = capacity;
+    c->entriessize = capacity ? capacity : COUNTER_MINIMUM_SIZE;
+    c->entries = malloc(c->entriessize * sizeof(*c->entries));
+    c->slots = slots_init(size);
+    c->size = size;
+
+    if (capacity){
+        c->heap = malloc(capacity * sizeof(*c->heap));
+    }
+
+    if (!c->entries || !c->slots || (capacity && !c->heap)){
+        log_write(
+            logger,
+            LOG_ERROR,
+            "[%s] counter_init_ex() - table alloc failed\n",
+            __FILE__
+        );
+
+        counter_free(c);
+
+        return NULL;
+    }
+
+    return c;
+}
+
+size_t counter_get_length(const counter *c){
+    if (!c){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] counter_get_length() - counter is NULL\n",
+            __FILE__
+        );
+
+        return 0;
+    }
+
+    return c->length;
+}
+
+uint64_t counter_get_total(const counter *c){
+    if (!c){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] counter_get_total() - counter is NULL\n",
+            __FILE__
+        );
+
+        return 0;
+    }
+
+    return c->total;
+}
+
+bool counter_inc(counter *c, size_t size, const void *key, uint64_t delta){
+    if (!c){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] counter_inc() - counter is NULL\n",
+            __FILE__
+        );
+
+        return false;
+    }
+    else if (!key){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] counter_inc() - key is NULL\n",
+            __FILE__
+        );
+
+        return false;
+    }
+
+    return add(c, wyhash(key, size, COUNTER_HASH_SEED), size, key, delta, 0);
+}
+
+uint64_t counter_get(const counter *c, size_t size, const void *key){
+    if (!c){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] counter_get() - counter is NULL\n",
+            __FILE__
+        );
+
+        return 0;
+    }
+    else if (!key){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] counter_get() - key is NULL\n",
+            __FILE__
+        );
+
+        return 0;
+    }
+
+    size_t slot;
+    uint32_t index = find_entry(c, wyhash(key, size, COUNTER_HASH_SEED), size, key, &slot);
+
+    return index != COUNTER_EMPTY ? c->entries[index].count : 0;
+}
+
+bool counter_get_item(const counter *c, size_t index, counter_item *item){
+    if (!c || !item){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] counter_get_item() - counter or item is NULL\n",
+            __FILE__
+        );
+
+        return false;
+    }
+    else if (index >= c->length){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] counter_get_item() - index (%ld) is out of range\n",
+            __FILE__,
+            index
+        );
+
+        return false;
+    }
+
+    item_from_entry(item, c->entries + index);
+
+    return true;
+}
+
+size_t counter_top(const counter *c, size_t k, counter_item *items){
+    if (!c || !items){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] counter_top() - counter or items is NULL\n",
+            __FILE__
+        );
+
+        return 0;
+    }
+
+    size_t length = k < c->length ? k : c->length;
+
+    if (!length){
+        return 0;
+    }
+
+    /* min-heap of the best length entries seen so far -- O(n log k) */
+    uint32_t *ranked = malloc(length * sizeof(*ranked));
+
+    if (!ranked){
+        log_write(
+            logger,
+            LOG_ERROR,
+            "[%s] counter_top() - ranked alloc failed\n",
+            __FILE__
+        );
+
+        return 0;
+    }
+
+    for (size_t index = 0; index < length; ++index){
+        ranked[index] = index;
+    }
+
+    for (size_t position = length / 2; position--;){
+        rank_down(c, ranked, length, position);
+    }
+
+    for (size_t index = length; index < c->length; ++index){
+        if (ranks_below(c, ranked[0], index)){
+            ranked[0] = index;
+
+            rank_down(c, ranked, length, 0);
+        }
+    }
+
+    /* popping the lowest fills items from the back */
+    for (size_t remaining = length; remaining; --remaining){
+        item_from_entry(items + remaining - 1, c->entries + ranked[0]);
+
+        ranked[0] = ranked[remaining - 1];
+
+        rank_down(c, ranked, remaining - 1, 0);
+    }
+
+    free(ranked);
+
+    return length;
+}
+
+bool counter_merge(counter *c, const counter *from){
+    if (!c || !from){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] counter_merge() - counter is NULL\n",
+            __FILE__
+        );
+
+        return false;
+    }
+    else if (c == from){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] counter_merge() - can't merge a counter into itself\n",
+            __FILE__
+        );
+
+        return false;
+    }
+
+    for (size_t index = 0; index < from->length; ++index){
+        const counter_entry *e = from->entries + index;
+
+        if (!add(c, e->hash, e->size, e->key, e->count, e->error)){
+            log_write(
+                logger,
+                LOG_ERROR,
+                "[%s] counter_merge() - add call failed\n",
+                __FILE__
+            );
+
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void counter_free(counter *c){
+    if (!c){
+        log_write(
+            logger,
+            LOG_DEBUG,
+            "[%s] counter_free() - counter is NULL\n",
+            __FILE__
+        );
+
+        return;
+    }
+
+    for (size_t index = 0; index < c->length; ++index){
+        free(c->entries[index].key);
+    }
+
+    free(c->entries);
+    free(c->slots);
+    free(c->heap);
+    free(c);
+}
@@ -0,0 +1,86 @@
+#ifndef COUNTER_H
+#define COUNTER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * counting map. counter_inc adds to a key's count in place with a
+ * single probe -- counts live next to the key instead of in a
+ * separately allocated map value.
+ *
+ * with a capacity it switches to space saving: at most capacity keys
+ * are kept and a new key replaces the one with the lowest count,
+ * taking over that count as its error. any key counted more than
+ * total / capacity times is always kept and a kept key's count is
+ * never more than error above its true count
+ */
+
+typedef struct counter_entry counter_entry;
+typedef struct counter_slot counter_slot;
+
+typedef struct counter_options {
+    /* 0 counts every key exactly */
+    size_t capacity;
+} counter_options;
+
+typedef struct counter {
+    /* dense, in insertion order until space saving starts replacing */
+    counter_entry *entries;
+    size_t length;
+    size_t entriessize;
+
+    /* linear probing index into entries */
+    counter_slot *slots;
+    size_t size;
+
+    /* sum of every delta added */
+    uint64_t total;
+
+    size_t capacity;
+
+    /* space saving only -- entry indexes as a min-heap on count */
+    uint32_t *heap;
+} counter;
+
+/* key and count as handed out -- key points into the counter */
+typedef struct counter_item {
+    size_t size;
+    const void *key;
+    uint64_t count;
+
+    /* 0 unless space saving replaced another key for this one */
+    uint64_t error;
+} counter_item;
+
+counter *counter_init(void);
+counter *counter_init_ex(const counter_options *);
+
+size_t counter_get_length(const counter *);
+uint64_t counter_get_total(const counter *);
+
+bool counter_inc(counter *, size_t, const void *, uint64_t);
+
+/* 0 for keys that aren't counted */
+uint64_t counter_get(const counter *, size_t, const void *);
+
+/* the entry at index, for index < length -- for walking every key */
+bool counter_get_item(const counter *, size_t, counter_item *);
+
+/*
+ * writes the (up to) k highest counts to items, highest first, and
+ * returns how many were written. items are valid until the counter
+ * is next modified
+ */
+size_t counter_top(const counter *, size_t, counter_item *);
+
+/*
+ * adds every count of the second counter to the first -- for per
+ * thread counters. errors add up as well
+ */
+bool counter_merge(counter *, const counter *);
+
+void counter_free(counter *);
+
+#endif
@@ -3,94 +3,124 @@
 #include "log.h"
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 static logctx *logger = NULL;
 
+/* holds a column's scalar until map_from_arrays copies it */
+typedef union column_scalar {
+    double number;
+    int64_t integer;
+} column_scalar;
+
 static bool append_rows_named(sqlite3 *db, sqlite3_stmt *stmt, list *res){
     int err = SQLITE_ROW;
 
-    do {
-        map *row = map_init();
+    map_options options = {0};
+    options.arena = true;
+    options.atoms = true;
 
-        if (!row){
+    size_t columns = sqlite3_column_count(stmt);
+
+    /* keys in the first half, values in the second -- the keys are the same for every row */
+    map_item *items = calloc(columns * 2 + 1, sizeof(*items));
+    column_scalar *scalars = calloc(columns + 1, sizeof(*scalars));
+
+    if (!items || !scalars){
+        log_write(
+            logger,
+            LOG_ERROR,
+            "[%s] append_rows_named() - items alloc failed\n",
+            __FILE__
+        );
+
+        free(items);
+        free(scalars);
+
+        return false;
+    }
+
+    map_item *keys = items;
+    map_item *values = items + columns;
+
+    for (size_t index = 0; index < columns; index++){
+        const char *cname = sqlite3_column_name(stmt, index);
+
+        keys[index].type = M_TYPE_STRING;
+        keys[index].size = strlen(cname);
+        keys[index].data_copy = cname;
+    }
+
+    bool success = true;
+
+    do {
+        if (err != SQLITE_DONE && err != SQLITE_ROW){
             log_write(
                 logger,
-                LOG_ERROR,
-                "[%s] append_rows() - row initialization failed\n",
-                __FILE__
+                LOG_WARNING,
+                "[%s] append_rows_named() - sqlite3_step failed: %s\n",
+                __FILE__,
+                sqlite3_errmsg(db)
             );
 
-            return false;
-        }
+            success = false;
 
-        size_t columns = sqlite3_column_count(stmt);
+            break;
+        }
 
         for (size_t index = 0; index < columns; index++){
-            if (err != SQLITE_DONE && err != SQLITE_ROW){
-                log_write(
-                    logger,
-                    LOG_WARNING,
-                    "[%s] append_rows() - sqlite3_step failed: %s\n",
-                    __FILE__,
-                    sqlite3_errmsg(db)
-                );
-
-                map_free(row);
-
-                return false;
-            }
-
             int ctype = sqlite3_column_type(stmt, index);
-            const char *cname = sqlite3_column_name(stmt, index);
 
-            map_item k = {0};
-            k.type = M_TYPE_STRING;
-            k.size = strlen(cname);
-            k.data_copy = cname;
+            map_item *v = values + index;
+            column_scalar *scalar = scalars + index;
 
-            map_item v = {0};
+            memset(v, 0, sizeof(*v));
 
             if (ctype == SQLITE_FLOAT){
-                double value = sqlite3_column_double(stmt, index);
+                scalar->number = sqlite3_column_double(stmt, index);
 
-                v.type = M_TYPE_DOUBLE;
-                v.size = sizeof(value);
-                v.data_copy = &value;
+                v->type = M_TYPE_DOUBLE;
+                v->size = sizeof(scalar->number);
+                v->data_copy = &scalar->number;
             }
             else if (ctype == SQLITE_INTEGER){
-                int64_t value = sqlite3_column_int64(stmt, index);
+                scalar->integer = sqlite3_column_int64(stmt, index);
 
-                v.type = M_TYPE_INT;
-                v.size = sizeof(value);
-                v.data_copy = &value;
+                v->type = M_TYPE_INT;
+                v->size = sizeof(scalar->integer);
+                v->data_copy = &scalar->integer;
             }
             else if (ctype == SQLITE_NULL){
                 void *value = NULL;
 
-                v.type = M_TYPE_NULL;
-                v.size = sizeof(value);
-                v.data = value;
+                v->type = M_TYPE_NULL;
+                v->size = sizeof(value);
+                v->data = value;
             }
             else {
                 const void *value = sqlite3_column_blob(stmt, index);
 
-                v.type = M_TYPE_STRING;
-                v.size = sqlite3_column_bytes(stmt, index);
-                v.data_copy = value;
+                v->type = M_TYPE_STRING;
+                v->size = sqlite3_column_bytes(stmt, index);
+                v->data_copy = value;
             }
+        }
 
-            if (!map_set(row, &k, &v)){
-                log_write(
-                    logger,
-                    LOG_ERROR,
-                    "[%s] append_rows_named() - map_set call failed\n",
-                    __FILE__
-                );
+        /* sized for all the columns at once instead of growing per map_set */
+        map *row = map_from_arrays(&options, columns, keys, values);
 
-                map_free(row);
+        if (!row){
+            log_write(
+                logger,
+                LOG_ERROR,
+                "[%s] append_rows_named() - map_from_arrays call failed\n",
+                __FILE__
+            );
 
-                return false;
-            }
+            success = false;
+
+            break;
         }
 
         list_item item = {0};
@@ -108,11 +138,16 @@ static bool append_rows_named(sqlite3 *db, sqlite3_stmt *stmt, list *res){
 
             map_free(row);
 
-            return false;
+            success = false;
+
+            break;
         }
     } while ((err = sqlite3_step(stmt)) == SQLITE_ROW);
 
-    return true;
+    free(items);
+    free(scalars);
+
+    return success;
 }
 
 static bool append_rows(sqlite3 *db, sqlite3_stmt *stmt, list *res){
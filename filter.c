@@ -0,0 +1,310 @@
+#include "filter.h"
+
+#include "log.h"
+
+#include "hashers/spooky.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FILTER_BLOCK_BITS (FILTER_BLOCK_WORDS * 64)
+#define FILTER_BLOCK_SIZE (FILTER_BLOCK_WORDS * sizeof(uint64_t))
+#define FILTER_MAXIMUM_PROBES 16
+
+/* bits per key for k probes is k / ln 2 */
+#define FILTER_BITS_PER_PROBE 1.4427
+
+static logctx *logger = NULL;
+
+static size_t block_index(const filter *f, uint64_t block){
+    /* the low bits of block often pick a table slot too, use the high ones */
+    block = (block >> 32) | (block << 32);
+
+    return (block & (f->blockcount - 1)) * FILTER_BLOCK_WORDS;
+}
+
+static uint64_t block_mask(uint64_t bits, unsigned probe, size_t *word){
+    uint64_t position = ((bits & UINT32_MAX) + probe * ((bits >> 32) | 1)) % FILTER_BLOCK_BITS;
+
+    *word = position >> 6;
+
+    return (uint64_t)1 << (position & 63);
+}
+
+filter *filter_init(size_t capacity, double rate){
+    if (!capacity){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] filter_init() - capacity cannot be 0\n",
+            __FILE__
+        );
+
+        return NULL;
+    }
+    else if (!(rate > 0.0 && rate < 1.0)){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] filter_init() - rate must be between 0 and 1\n",
+            __FILE__
+        );
+
+        return NULL;
+    }
+
+    filter *f = malloc(sizeof(*f));
+
+    if (!f){
+        log_write(
+            logger,
+            LOG_ERROR,
+            "[%s] filter_init() - filter alloc failed\n",
+            __FILE__
+        );
+
+        return NULL;
+    }
+
+    /* the best probe count is log2(1 / rate) */
+    unsigned probes = 0;
+
+    for (double r = rate; r < 1.0 && probes < FILTER_MAXIMUM_PROBES; r *= 2){
+        ++probes;
+    }
+
+    size_t bits = (size_t)(capacity * probes * FILTER_BITS_PER_PROBE);
+    size_t blockcount = 1;
+
+    while (blockcount * FILTER_BLOCK_BITS < bits){
+        blockcount <<= 1;
+    }
+
+    f->blocks = aligned_alloc(FILTER_BLOCK_SIZE, blockcount * FILTER_BLOCK_SIZE);
+
+    if (!f->blocks){
+        log_write(
+            logger,
+            LOG_ERROR,
+            "[%s] filter_init() - blocks alloc failed\n",
+            __FILE__
+        );
+
+        free(f);
+
+        return NULL;
+    }
+
+    memset(f->blocks, 0, blockcount * FILTER_BLOCK_SIZE);
+
+    f->blockcount = blockcount;
+    f->probes = probes;
+    f->capacity = capacity;
+    f->rate = rate;
+    f->length = 0;
+    f->seed = (uint64_t)&f;
+
+    return f;
+}
+
+filter *filter_copy(const filter *f){
+    if (!f){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] filter_copy() - filter is NULL\n",
+            __FILE__
+        );
+
+        return NULL;
+    }
+
+    filter *copy = filter_init(f->capacity, f->rate);
+
+    if (!copy){
+        log_write(
+            logger,
+            LOG_ERROR,
+            "[%s] filter_copy() - filter initialization failed\n",
+            __FILE__
+        );
+
+        return NULL;
+    }
+
+    memcpy(copy->blocks, f->blocks, f->blockcount * FILTER_BLOCK_SIZE);
+
+    copy->length = f->length;
+    copy->seed = f->seed;
+
+    return copy;
+}
+
+size_t filter_get_length(const filter *f){
+    if (!f){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] filter_get_length() - filter is NULL\n",
+            __FILE__
+        );
+
+        return 0;
+    }
+
+    return f->length;
+}
+
+size_t filter_get_capacity(const filter *f){
+    if (!f){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] filter_get_capacity() - filter is NULL\n",
+            __FILE__
+        );
+
+        return 0;
+    }
+
+    return f->capacity;
+}
+
+size_t filter_get_bytes(const filter *f){
+    if (!f){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] filter_get_bytes() - filter is NULL\n",
+            __FILE__
+        );
+
+        return 0;
+    }
+
+    return f->blockcount * FILTER_BLOCK_SIZE;
+}
+
+void filter_add_hash(filter *f, uint64_t block, uint64_t bits){
+    if (!f){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] filter_add_hash() - filter is NULL\n",
+            __FILE__
+        );
+
+        return;
+    }
+
+    uint64_t *words = f->blocks + block_index(f, block);
+
+    for (unsigned probe = 0; probe < f->probes; ++probe){
+        size_t word;
+        uint64_t mask = block_mask(bits, probe, &word);
+
+        words[word] |= mask;
+    }
+
+    ++f->length;
+}
+
+bool filter_contains_hash(const filter *f, uint64_t block, uint64_t bits){
+    if (!f){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] filter_contains_hash() - filter is NULL\n",
+            __FILE__
+        );
+
+        return false;
+    }
+
+    const uint64_t *words = f->blocks + block_index(f, block);
+
+    for (unsigned probe = 0; probe < f->probes; ++probe){
+        size_t word;
+        uint64_t mask = block_mask(bits, probe, &word);
+
+        if (!(words[word] & mask)){
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void filter_add(filter *f, size_t size, const void *key){
+    if (!f || !key){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] filter_add() - filter or key is NULL\n",
+            __FILE__
+        );
+
+        return;
+    }
+
+    uint64_t block = f->seed;
+    uint64_t bits = f->seed;
+
+    spooky_hash128(key, size, &block, &bits);
+
+    filter_add_hash(f, block, bits);
+}
+
+bool filter_contains(const filter *f, size_t size, const void *key){
+    if (!f || !key){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] filter_contains() - filter or key is NULL\n",
+            __FILE__
+        );
+
+        return false;
+    }
+
+    uint64_t block = f->seed;
+    uint64_t bits = f->seed;
+
+    spooky_hash128(key, size, &block, &bits);
+
+    return filter_contains_hash(f, block, bits);
+}
+
+void filter_clear(filter *f){
+    if (!f){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] filter_clear() - filter is NULL\n",
+            __FILE__
+        );
+
+        return;
+    }
+
+    memset(f->blocks, 0, f->blockcount * FILTER_BLOCK_SIZE);
+
+    f->length = 0;
+}
+
+void filter_free(filter *f){
+    if (!f){
+        log_write(
+            logger,
+            LOG_DEBUG,
+            "[%s] filter_free() - filter is NULL\n",
+            __FILE__
+        );
+
+        return;
+    }
+
+    free(f->blocks);
+    free(f);
+}
@@ -0,0 +1,48 @@
+#ifndef FILTER_H
+#define FILTER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * blocked bloom filter. all bits of a key are set inside one 64 byte
+ * block, so a query is a single cache line load. there are no false
+ * negatives and about rate false positives while no more than
+ * capacity keys were added. keys can't be removed -- clear or rebuild
+ */
+
+#define FILTER_DEFAULT_RATE 0.01
+#define FILTER_BLOCK_WORDS 8
+
+typedef struct filter {
+    uint64_t *blocks;
+    size_t blockcount;
+    unsigned probes;
+
+    size_t capacity;
+    double rate;
+    size_t length;
+
+    uint64_t seed;
+} filter;
+
+filter *filter_init(size_t, double);
+filter *filter_copy(const filter *);
+
+size_t filter_get_length(const filter *);
+size_t filter_get_capacity(const filter *);
+size_t filter_get_bytes(const filter *);
+
+/* keys are hashed with spooky_hash128, one half picks the block and the other the bits */
+void filter_add(filter *, size_t, const void *);
+bool filter_contains(const filter *, size_t, const void *);
+
+/* for callers that already have two independent 64-bit hashes of the key */
+void filter_add_hash(filter *, uint64_t, uint64_t);
+bool filter_contains_hash(const filter *, uint64_t, uint64_t);
+
+void filter_clear(filter *);
+void filter_free(filter *);
+
+#endif
@@ -0,0 +1,638 @@
+#include "fmap.h"
+
+#include "list.h"
+#include "log.h"
+
+#include "hashers/wyhash.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* give up on a seed after this many displacements for one bucket */
+#define FMAP_MAXIMUM_DISPLACEMENT (1u << 24)
+#define FMAP_MAXIMUM_ATTEMPTS 8
+#define FMAP_ALIGN _Alignof(max_align_t)
+
+static logctx *logger = NULL;
+
+typedef struct fmap_slot {
+    uint64_t hash;
+    map_item key;
+    map_item value;
+} fmap_slot;
+
+typedef struct fmap_bucket {
+    uint32_t index;
+    uint32_t size;
+} fmap_bucket;
+
+static uint64_t generate_hash(const fmap *f, size_t size, const void *key){
+    return wyhash(key, size, f->seed);
+}
+
+/* every displacement gives an unrelated slot for the same hash */
+static size_t slot_position(uint64_t hash, uint32_t displacement, size_t length){
+    uint64_t x = hash + displacement * 0x9E3779B97F4A7C15ULL;
+
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9ULL;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBULL;
+    x ^= x >> 31;
+
+    return x % length;
+}
+
+static size_t align_size(size_t size){
+    return (size + FMAP_ALIGN - 1) & ~(FMAP_ALIGN - 1);
+}
+
+/* lists and maps keep their own copy, the rest is flattened into data */
+static bool value_is_flat(mtype type){
+    return type != M_TYPE_LIST && type != M_TYPE_MAP && type != M_TYPE_NULL;
+}
+
+static int bucket_compare(const void *a, const void *b){
+    const fmap_bucket *x = a;
+    const fmap_bucket *y = b;
+
+    if (x->size != y->size){
+        return x->size < y->size ? 1 : -1;
+    }
+
+    return x->index < y->index ? -1 : x->index > y->index;
+}
+
+/*
+ * hash and displace -- buckets are placed largest first, each trying
+ * displacements until all of its keys land on free slots. positions
+ * gets the slot of every key
+ */
+static bool place(fmap *f, const uint64_t *hashes, size_t *positions){
+    size_t length = f->length;
+
+    uint32_t *offsets = calloc(f->buckets + 1, sizeof(*offsets));
+    uint32_t *members = malloc(length * sizeof(*members));
+    fmap_bucket *order = malloc(f->buckets * sizeof(*order));
+    bool *taken = calloc(length, sizeof(*taken));
+
+    bool placed = offsets && members && order && taken;
+
+    if (!placed){
+        log_write(
+            logger,
+            LOG_ERROR,
+            "[%s] place() - scratch alloc failed\n",
+            __FILE__
+        );
+    }
+
+    if (placed){
+        /* counting sort of the keys by bucket */
+        for (size_t index = 0; index < length; ++index){
+            ++offsets[hashes[index] % f->buckets + 1];
+        }
+
+        for (size_t index = 0; index < f->buckets; ++index){
+            order[index].index = (uint32_t)index;
+            order[index].size = offsets[index + 1];
+
+            offsets[index + 1] += offsets[index];
+        }
+
+        for (size_t index = 0; index < length; ++index){
+            size_t bucket = hashes[index] % f->buckets;
+
+            members[offsets[bucket] + --order[bucket].size] = (uint32_t)index;
+        }
+
+        for (size_t index = 0; index < f->buckets; ++index){
+            order[index].size = offsets[index + 1] - offsets[index];
+        }
+
+        qsort(order, f->buckets, sizeof(*order), bucket_compare);
+    }
+
+    for (size_t index = 0; placed && index < f->buckets && order[index].size; ++index){
+        const uint32_t *keys = members + offsets[order[index].index];
+        uint32_t size = order[index].size;
+
+        uint32_t displacement = 0;
+
+        for (; displacement < FMAP_MAXIMUM_DISPLACEMENT; ++displacement){
+            uint32_t count = 0;
+
+            for (; count < size; ++count){
+                size_t position = slot_position(hashes[keys[count]], displacement, length);
+
+                if (taken[position]){
+                    break;
+                }
+
+                positions[keys[count]] = position;
+                taken[position] = true;
+            }
+
+            if (count == size){
+                break;
+            }
+
+            /* release the keys of this bucket that did fit */
+            for (uint32_t undo = 0; undo < count; ++undo){
+                taken[positions[keys[undo]]] = false;
+            }
+
+            /* equal hashes collide under every displacement */
+            if (displacement == 0 && size > 1){
+                bool duplicate = false;
+
+                for (uint32_t a = 0; a < size && !duplicate; ++a){
+                    for (uint32_t b = a + 1; b < size && !duplicate; ++b){
+                        duplicate = hashes[keys[a]] == hashes[keys[b]];
+                    }
+                }
+
+                if (duplicate){
+                    displacement = FMAP_MAXIMUM_DISPLACEMENT;
+
+                    break;
+                }
+            }
+        }
+
+        if (displacement >= FMAP_MAXIMUM_DISPLACEMENT){
+            placed = false;
+        }
+        else {
+            f->displacements[order[index].index] = displacement;
+        }
+    }
+
+    free(offsets);
+    free(members);
+    free(order);
+    free(taken);
+
+    return placed;
+}
+
+static bool slot_init(fmap_slot *s, uint64_t hash, const map_item *key, const map_item *value, char **data){
+    s->hash = hash;
+    s->key = *key;
+    s->key.inlined = false;
+    s->key.data = *data;
+    s->key.data_copy = NULL;
+    s->key.generic_free = NULL;
+
+    memcpy(*data, key->data, key->size);
+    (*data)[key->size] = '\0';
+    *data += align_size(key->size + 1);
+
+    s->value = *value;
+    s->value.inlined = false;
+    s->value.data_copy = NULL;
+    s->value.generic_free = NULL;
+
+    if (value->type == M_TYPE_LIST){
+        s->value.data = list_copy(value->data);
+    }
+    else if (value->type == M_TYPE_MAP){
+        s->value.data = map_copy(value->data);
+    }
+    else if (value_is_flat(value->type)){
+        s->value.data = *data;
+
+        memcpy(*data, value->data, value->size);
+        (*data)[value->size] = '\0';
+        *data += align_size(value->size + 1);
+    }
+
+    if (value->type != M_TYPE_NULL && !s->value.data){
+        log_write(
+            logger,
+            LOG_ERROR,
+            "[%s] slot_init() - value copy failed\n",
+            __FILE__
+        );
+
+        return false;
+    }
+
+    return true;
+}
+
+static void slot_free(fmap_slot *s){
+    if (s->value.type == M_TYPE_LIST){
+        list_free(s->value.data);
+    }
+    else if (s->value.type == M_TYPE_MAP){
+        map_free(s->value.data);
+    }
+}
+
+static const fmap_slot *find_slot(const fmap *f, size_t size, const void *key){
+    if (!f->length){
+        return NULL;
+    }
+
+    uint64_t hash = generate_hash(f, size, key);
+    const fmap_slot *s = f->slots + slot_position(hash, f->displacements[hash % f->buckets], f->length);
+
+    if (s->hash != hash || s->key.size != size || memcmp(key, s->key.data, size)){
+        return NULL;
+    }
+
+    return s;
+}
+
+static const fmap_slot *get_slot(const fmap *f, size_t size, const void *key, mtype type){
+    if (!f){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] get_slot() - fmap is NULL\n",
+            __FILE__
+        );
+
+        return NULL;
+    }
+    else if (!key){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] get_slot() - key is NULL\n",
+            __FILE__
+        );
+
+        return NULL;
+    }
+
+    const fmap_slot *s = find_slot(f, size, key);
+
+    if (!s){
+        log_write(
+            logger,
+            LOG_DEBUG,
+            "[%s] get_slot() - key does not exist\n",
+            __FILE__
+        );
+
+        return NULL;
+    }
+
+    if (type != M_TYPE_RESERVED_EMPTY && s->value.type != type){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] get_slot() - slot type does *not* match\n",
+            __FILE__
+        );
+    }
+
+    return s;
+}
+
+fmap *fmap_init(const map *m){
+    if (!m){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] fmap_init() - map is NULL\n",
+            __FILE__
+        );
+
+        return NULL;
+    }
+
+    size_t length = map_get_length(m);
+
+    if (length >= UINT32_MAX){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] fmap_init() - map is too large\n",
+            __FILE__
+        );
+
+        return NULL;
+    }
+
+    fmap *f = calloc(1, sizeof(*f));
+
+    if (!f){
+        log_write(
+            logger,
+            LOG_ERROR,
+            "[%s] fmap_init() - fmap alloc failed\n",
+            __FILE__
+        );
+
+        return NULL;
+    }
+
+    f->length = length;
+    f->buckets = (length + FMAP_BUCKET_LOAD - 1) / FMAP_BUCKET_LOAD;
+    f->seed = (uint64_t)&f;
+
+    if (!length){
+        return f;
+    }
+
+    map_item *keys = malloc(length * sizeof(*keys));
+    map_item *values = malloc(length * sizeof(*values));
+    uint64_t *hashes = malloc(length * sizeof(*hashes));
+    size_t *positions = malloc(length * sizeof(*positions));
+    mapiter *iter = map_iter_init(m);
+
+    f->displacements = calloc(f->buckets, sizeof(*f->displacements));
+
+    if (!keys || !values || !hashes || !positions || !iter || !f->displacements){
+        log_write(
+            logger,
+            LOG_ERROR,
+            "[%s] fmap_init() - scratch alloc failed\n",
+            __FILE__
+        );
+
+        free(keys);
+        free(values);
+        free(hashes);
+        free(positions);
+        map_iter_free(iter);
+        fmap_free(f);
+
+        return NULL;
+    }
+
+    /* the items are only borrowed from m until they are copied below */
+    size_t datasize = 0;
+
+    for (size_t index = 0; map_iter_next(iter); ++index){
+        map_iter_get_key(iter, keys + index);
+        map_iter_get_value(iter, values + index);
+
+        datasize += align_size(keys[index].size + 1);
+
+        if (value_is_flat(values[index].type)){
+            datasize += align_size(values[index].size + 1);
+        }
+    }
+
+    map_iter_free(iter);
+
+    bool placed = false;
+
+    for (size_t attempt = 0; !placed && attempt < FMAP_MAXIMUM_ATTEMPTS; ++attempt){
+        if (attempt){
+            f->seed = wyhash(&f->seed, sizeof(f->seed), attempt);
+        }
+
+        for (size_t index = 0; index < length; ++index){
+            hashes[index] = generate_hash(f, keys[index].size, keys[index].data);
+        }
+
+        placed = place(f, hashes, positions);
+    }
+
+    f->slots = calloc(length, sizeof(*f->slots));
+    f->data = malloc(datasize);
+
+    if (!placed || !f->slots || !f->data){
+        log_write(
+            logger,
+            LOG_ERROR,
+            "[%s] fmap_init() - unable to place every key\n",
+            __FILE__
+        );
+
+        free(keys);
+        free(values);
+        free(hashes);
+        free(positions);
+        fmap_free(f);
+
+        return NULL;
+    }
+
+    /* positions is a permutation, invert it to pack data in slot order */
+    size_t *sources = malloc(length * sizeof(*sources));
+    bool copied = sources != NULL;
+
+    if (sources){
+        for (size_t index = 0; index < length; ++index){
+            sources[positions[index]] = index;
+        }
+    }
+
+    char *data = f->data;
+
+    for (size_t index = 0; copied && index < length; ++index){
+        size_t source = sources[index];
+
+        copied = slot_init(f->slots + index, hashes[source], keys + source, values + source, &data);
+    }
+
+    free(keys);
+    free(values);
+    free(hashes);
+    free(positions);
+    free(sources);
+
+    if (!copied){
+        log_write(
+            logger,
+            LOG_ERROR,
+            "[%s] fmap_init() - slot copy failed\n",
+            __FILE__
+        );
+
+        fmap_free(f);
+
+        return NULL;
+    }
+
+    return f;
+}
+
+size_t fmap_get_length(const fmap *f){
+    if (!f){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] fmap_get_length() - fmap is NULL\n",
+            __FILE__
+        );
+
+        return 0;
+    }
+
+    return f->length;
+}
+
+mstatus fmap_try_get(const fmap *f, size_t size, const void *key, mtype type, const map_item **value){
+    if (value){
+        *value = NULL;
+    }
+
+    if (!f || !key){
+        return M_STATUS_INVALID;
+    }
+
+    const fmap_slot *s = find_slot(f, size, key);
+
+    if (!s){
+        return M_STATUS_NOT_FOUND;
+    }
+
+    if (value){
+        *value = &s->value;
+    }
+
+    if (type != M_TYPE_RESERVED_EMPTY && s->value.type != type){
+        return M_STATUS_TYPE_MISMATCH;
+    }
+
+    return M_STATUS_OK;
+}
+
+bool fmap_contains(const fmap *f, size_t size, const void *key){
+    return get_slot(f, size, key, M_TYPE_RESERVED_EMPTY);
+}
+
+mtype fmap_get_type(const fmap *f, size_t size, const void *key){
+    const fmap_slot *s = get_slot(f, size, key, M_TYPE_RESERVED_EMPTY);
+
+    if (!s){
+        return M_TYPE_RESERVED_ERROR;
+    }
+
+    return s->value.type;
+}
+
+bool fmap_get_bool(const fmap *f, size_t size, const void *key){
+    const fmap_slot *s = get_slot(f, size, key, M_TYPE_BOOL);
+
+    if (!s){
+        return false;
+    }
+
+    return *(bool *)s->value.data;
+}
+
+char fmap_get_char(const fmap *f, size_t size, const void *key){
+    const fmap_slot *s = get_slot(f, size, key, M_TYPE_CHAR);
+
+    if (!s){
+        return 0;
+    }
+
+    return *(char *)s->value.data;
+}
+
+double fmap_get_double(const fmap *f, size_t size, const void *key){
+    const fmap_slot *s = get_slot(f, size, key, M_TYPE_DOUBLE);
+
+    if (!s){
+        return 0.0;
+    }
+
+    return *(double *)s->value.data;
+}
+
+int64_t fmap_get_int(const fmap *f, size_t size, const void *key){
+    const fmap_slot *s = get_slot(f, size, key, M_TYPE_INT);
+
+    if (!s){
+        return 0;
+    }
+
+    return *(int64_t *)s->value.data;
+}
+
+uint64_t fmap_get_uint(const fmap *f, size_t size, const void *key){
+    const fmap_slot *s = get_slot(f, size, key, M_TYPE_UINT);
+
+    if (!s){
+        return 0;
+    }
+
+    return *(uint64_t *)s->value.data;
+}
+
+size_t fmap_get_size_t(const fmap *f, size_t size, const void *key){
+    const fmap_slot *s = get_slot(f, size, key, M_TYPE_SIZE_T);
+
+    if (!s){
+        return 0;
+    }
+
+    return *(size_t *)s->value.data;
+}
+
+/*
+ * READ WARNING FOR THESE FUNCTIONS IN HEADER FILE
+ */
+const char *fmap_get_string(const fmap *f, size_t size, const void *key){
+    const fmap_slot *s = get_slot(f, size, key, M_TYPE_STRING);
+
+    if (!s){
+        return NULL;
+    }
+
+    return s->value.data;
+}
+
+const list *fmap_get_list(const fmap *f, size_t size, const void *key){
+    const fmap_slot *s = get_slot(f, size, key, M_TYPE_LIST);
+
+    if (!s){
+        return NULL;
+    }
+
+    return s->value.data;
+}
+
+const map *fmap_get_map(const fmap *f, size_t size, const void *key){
+    const fmap_slot *s = get_slot(f, size, key, M_TYPE_MAP);
+
+    if (!s){
+        return NULL;
+    }
+
+    return s->value.data;
+}
+
+const void *fmap_get_generic(const fmap *f, size_t size, const void *key){
+    const fmap_slot *s = get_slot(f, size, key, M_TYPE_GENERIC);
+
+    if (!s){
+        return NULL;
+    }
+
+    return s->value.data;
+}
+
+void fmap_free(fmap *f){
+    if (!f){
+        log_write(
+            logger,
+            LOG_DEBUG,
+            "[%s] fmap_free() - fmap is NULL\n",
+            __FILE__
+        );
+
+        return;
+    }
+
+    if (f->slots){
+        for (size_t index = 0; index < f->length; ++index){
+            slot_free(f->slots + index);
+        }
+    }
+
+    free(f->slots);
+    free(f->displacements);
+    free(f->data);
+    free(f);
+}
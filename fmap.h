@@ -0,0 +1,66 @@
+#ifndef FMAP_H
+#define FMAP_H
+
+#include "map.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * frozen map -- a read only copy of a map behind a minimal perfect
+ * hash (hash and displace). every key owns exactly one slot, so a
+ * lookup is one hash, one displacement read and one slot compare.
+ * keys and flat values are packed into a single block in slot order.
+ * meant for static tables built once at startup -- building is
+ * O(n log n) expected and it can't be modified afterwards
+ */
+
+/* average keys per displacement bucket */
+#define FMAP_BUCKET_LOAD 5
+
+typedef struct fmap_slot fmap_slot;
+
+typedef struct fmap {
+    fmap_slot *slots;
+    size_t length;
+
+    /* one displacement per bucket, picks the slot of the bucket's keys */
+    uint32_t *displacements;
+    size_t buckets;
+
+    uint64_t seed;
+
+    /* keys and every value that isn't a list or map */
+    char *data;
+} fmap;
+
+/* copies m, NULL if the keys can't be placed */
+fmap *fmap_init(const map *);
+
+size_t fmap_get_length(const fmap *);
+
+/* silent lookup, same as map_try_get */
+mstatus fmap_try_get(const fmap *, size_t, const void *, mtype, const map_item **);
+
+bool fmap_contains(const fmap *, size_t, const void *);
+mtype fmap_get_type(const fmap *, size_t, const void *);
+bool fmap_get_bool(const fmap *, size_t, const void *);
+char fmap_get_char(const fmap *, size_t, const void *);
+double fmap_get_double(const fmap *, size_t, const void *);
+int64_t fmap_get_int(const fmap *, size_t, const void *);
+uint64_t fmap_get_uint(const fmap *, size_t, const void *);
+size_t fmap_get_size_t(const fmap *, size_t, const void *);
+
+/* ------------------ WARNING ------------------
+ * the fmap owns these, they are valid until
+ * fmap_free and MUST NOT be modified or free'd
+ */
+const char *fmap_get_string(const fmap *, size_t, const void *);
+const list *fmap_get_list(const fmap *, size_t, const void *);
+const map *fmap_get_map(const fmap *, size_t, const void *);
+const void *fmap_get_generic(const fmap *, size_t, const void *);
+
+void fmap_free(fmap *);
+
+#endif
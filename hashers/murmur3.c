@@ -111,6 +111,7 @@ void MurmurHash3_x86_32 ( const void * key, int len,
   case 2: k1 ^= tail[1] << 8;
   case 1: k1 ^= tail[0];
           k1 *= c1; k1 = ROTL32(k1,15); k1 *= c2; h1 ^= k1;
+  default: break;
   };
 
   //----------
@@ -205,6 +206,7 @@ void MurmurHash3_x86_128 ( const void * key, const int len,
   case  2: k1 ^= tail[ 1] << 8;
   case  1: k1 ^= tail[ 0] << 0;
            k1 *= c1; k1  = ROTL32(k1,15); k1 *= c2; h1 ^= k1;
+  default: break;
   };
 
   //----------
@@ -291,6 +293,7 @@ void MurmurHash3_x64_128 ( const void * key, const int len,
   case  2: k1 ^= (uint64_t)(tail[ 1]) << 8;
   case  1: k1 ^= (uint64_t)(tail[ 0]) << 0;
            k1 *= c1; k1  = ROTL64(k1,31); k1 *= c2; h1 ^= k1;
+  default: break;
   };
 
   //----------
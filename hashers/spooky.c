@@ -330,6 +330,9 @@ spooky_short(const void *restrict message, size_t length,
 	case 0:
 		h[2] += SC_CONST;
 		h[3] += SC_CONST;
+		break;
+	default:
+		break;
 	}
 	spooky_short_end(h);
 	*hash1 = h[0];
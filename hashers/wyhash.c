@@ -0,0 +1,135 @@
+/*
+ * wyhash - fast 64-bit noncryptographic hash function
+ *
+ * Written by Wang Yi <godspeed_china@yeah.net>
+ *
+ * This is free and unencumbered software released into the public domain
+ * (The Unlicense). See <http://unlicense.org/>.
+ */
+
+#include "wyhash.h"
+
+#include <string.h>
+
+static const uint64_t wyp[4] = {
+	0x2d358dccaa6c78a5ULL, 0x8bb84b93962eacc9ULL,
+	0x4b33a62ed433d4a3ULL, 0x4d5a2da51de1aa47ULL
+};
+
+static inline void
+wymum(uint64_t *a, uint64_t *b)
+{
+#ifdef __SIZEOF_INT128__
+	__extension__ typedef unsigned __int128 wyu128;
+
+	wyu128 r = *a;
+	r *= *b;
+	*a = (uint64_t) r;
+	*b = (uint64_t) (r >> 64);
+#else
+	uint64_t ha = *a >> 32, hb = *b >> 32;
+	uint64_t la = (uint32_t) *a, lb = (uint32_t) *b;
+	uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+	uint64_t t = rl + (rm0 << 32), c = t < rl;
+	uint64_t lo = t + (rm1 << 32);
+
+	c += lo < t;
+	*a = lo;
+	*b = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+#endif
+}
+
+static inline uint64_t
+wymix(uint64_t a, uint64_t b)
+{
+	wymum(&a, &b);
+	return a ^ b;
+}
+
+/* assumes a little-endian host, like spooky */
+static inline uint64_t
+wyr8(const uint8_t *p)
+{
+	uint64_t v;
+	memcpy(&v, p, 8);
+	return v;
+}
+
+static inline uint64_t
+wyr4(const uint8_t *p)
+{
+	uint32_t v;
+	memcpy(&v, p, 4);
+	return v;
+}
+
+static inline uint64_t
+wyr3(const uint8_t *p, size_t k)
+{
+	return (((uint64_t) p[0]) << 16) | (((uint64_t) p[k >> 1]) << 8) | p[k - 1];
+}
+
+uint64_t
+wyhash(const void *key, size_t length, uint64_t seed)
+{
+	const uint8_t *p = (const uint8_t *) key;
+	uint64_t a, b;
+
+	seed ^= wymix(seed ^ wyp[0], wyp[1]);
+
+	if (length <= 16) {
+		if (length >= 4) {
+			a = (wyr4(p) << 32) | wyr4(p + ((length >> 3) << 2));
+			b = (wyr4(p + length - 4) << 32) | wyr4(p + length - 4 - ((length >> 3) << 2));
+		}
+		else if (length > 0) {
+			a = wyr3(p, length);
+			b = 0;
+		}
+		else {
+			a = b = 0;
+		}
+	}
+	else {
+		size_t i = length;
+
+		if (i >= 48) {
+			uint64_t see1 = seed, see2 = seed;
+
+			do {
+				seed = wymix(wyr8(p) ^ wyp[1], wyr8(p + 8) ^ seed);
+				see1 = wymix(wyr8(p + 16) ^ wyp[2], wyr8(p + 24) ^ see1);
+				see2 = wymix(wyr8(p + 32) ^ wyp[3], wyr8(p + 40) ^ see2);
+				p += 48;
+				i -= 48;
+			} while (i >= 48);
+
+			seed ^= see1 ^ see2;
+		}
+
+		while (i > 16) {
+			seed = wymix(wyr8(p) ^ wyp[1], wyr8(p + 8) ^ seed);
+			i -= 16;
+			p += 16;
+		}
+
+		a = wyr8(p + i - 16);
+		b = wyr8(p + i - 8);
+	}
+
+	a ^= wyp[1];
+	b ^= seed;
+	wymum(&a, &b);
+
+	return wymix(a ^ wyp[0] ^ length, b ^ wyp[1]);
+}
+
+uint64_t
+wyhash64(uint64_t a, uint64_t b)
+{
+	a ^= wyp[0];
+	b ^= wyp[1];
+	wymum(&a, &b);
+
+	return wymix(a ^ wyp[0], b ^ wyp[1]);
+}
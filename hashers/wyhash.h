@@ -0,0 +1,35 @@
+/*
+ * wyhash - fast 64-bit noncryptographic hash function
+ *
+ * Written by Wang Yi <godspeed_china@yeah.net>
+ *
+ * This is free and unencumbered software released into the public domain
+ * (The Unlicense). See <http://unlicense.org/>.
+ *
+ * Trimmed C port of wyhash final version 4: the 64-bit hash only, with
+ * the default secret. Short keys (16 bytes or less) are read with at most
+ * four loads and a single 64x64->128 multiply, which makes it a good fit
+ * for hash tables full of small keys.
+ */
+
+#ifndef WYHASH_H_INCLUDED
+#define WYHASH_H_INCLUDED
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+uint64_t
+wyhash(const void *key, size_t length, uint64_t seed);
+
+uint64_t
+wyhash64(uint64_t a, uint64_t b);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* WYHASH_H_INCLUDED */
@@ -694,13 +694,16 @@ http_response *http_request(http_client *http, http_method method, const char *p
         return NULL;
     }
 
-    map *responseheaders = map_init();
+    map_options options = {0};
+    options.atoms = true;
+
+    map *responseheaders = map_init_ex(&options);
 
     if (!responseheaders){
         log_write(
             logger,
             LOG_ERROR,
-            "[%s] http_request() - map_init call failed\n",
+            "[%s] http_request() - map_init_ex call failed\n",
             __FILE__
         );
 
@@ -0,0 +1,1051 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "image.h"
+
+#include "log.h"
+
+#include "hashers/wyhash.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define IMAGE_MAGIC "MAPIMAGE"
+#define IMAGE_MAGIC_SIZE 8
+#define IMAGE_ALIGN 8
+#define IMAGE_MINIMUM_SLOTS 8
+#define IMAGE_HASH_SEED 0x6A09E667F3BCC909ULL
+
+static logctx *logger = NULL;
+
+typedef enum {
+    IMAGE_MAP,
+    IMAGE_LIST
+} image_kind;
+
+/* how a value is stored after the records that point at it */
+typedef enum {
+    PAYLOAD_NONE,
+    PAYLOAD_BYTES,
+    PAYLOAD_LIST,
+    PAYLOAD_MAP
+} image_payload;
+
+typedef struct image_header {
+    char magic[IMAGE_MAGIC_SIZE];
+    uint32_t version;
+    uint32_t kind;
+    uint64_t size;
+} image_header;
+
+/* offset is relative to the item itself, 0 when there is no payload */
+typedef struct image_item {
+    uint32_t type;
+    uint32_t reserved;
+    uint64_t size;
+    int64_t offset;
+} image_item;
+
+typedef struct image_entry {
+    uint64_t hash;
+    image_item key;
+    image_item value;
+} image_entry;
+
+/*
+ * entries are followed by slotcount uint32_t hash slots (entry + 1,
+ * 0 is empty, linear probing) and then the payloads
+ */
+typedef struct mimage {
+    uint64_t length;
+    uint64_t slotcount;
+    image_entry entries[];
+} mimage;
+
+typedef struct limage {
+    uint64_t length;
+    image_item items[];
+} limage;
+
+typedef struct image_writer {
+    FILE *file;
+    uint64_t position;
+    bool failed;
+} image_writer;
+
+static uint64_t map_size(const map *);
+static uint64_t list_size(const list *);
+static void write_map(image_writer *, const map *);
+static void write_list(image_writer *, const list *);
+
+static uint64_t align_size(uint64_t size){
+    return (size + IMAGE_ALIGN - 1) & ~(uint64_t)(IMAGE_ALIGN - 1);
+}
+
+static uint64_t slot_count(uint64_t length){
+    uint64_t count = IMAGE_MINIMUM_SLOTS;
+
+    while (count < length * 2){
+        count <<= 1;
+    }
+
+    return count;
+}
+
+static image_payload map_payload(mtype type){
+    if (type == M_TYPE_NULL){
+        return PAYLOAD_NONE;
+    }
+    else if (type == M_TYPE_LIST){
+        return PAYLOAD_LIST;
+    }
+    else if (type == M_TYPE_MAP){
+        return PAYLOAD_MAP;
+    }
+
+    return PAYLOAD_BYTES;
+}
+
+static image_payload list_payload(ltype type){
+    if (type == L_TYPE_NULL){
+        return PAYLOAD_NONE;
+    }
+    else if (type == L_TYPE_LIST){
+        return PAYLOAD_LIST;
+    }
+    else if (type == L_TYPE_MAP){
+        return PAYLOAD_MAP;
+    }
+
+    return PAYLOAD_BYTES;
+}
+
+/* bytes get a trailing NUL so strings can be used in place */
+static uint64_t payload_size(image_payload payload, size_t size, const void *data){
+    if (payload == PAYLOAD_BYTES){
+        return align_size(size + 1);
+    }
+    else if (payload == PAYLOAD_LIST){
+        return list_size(data);
+    }
+    else if (payload == PAYLOAD_MAP){
+        return map_size(data);
+    }
+
+    return 0;
+}
+
+static uint64_t map_size(const map *m){
+    uint64_t length = map_get_length(m);
+    uint64_t size = sizeof(mimage) + length * sizeof(image_entry);
+
+    size += align_size(slot_count(length) * sizeof(uint32_t));
+
+    mapiter *iter = map_iter_init(m);
+
+    while (iter && map_iter_next(iter)){
+        map_item key, value;
+
+        map_iter_get_key(iter, &key);
+        map_iter_get_value(iter, &value);
+
+        size += payload_size(PAYLOAD_BYTES, key.size, key.data);
+        size += payload_size(map_payload(value.type), value.size, value.data);
+    }
+
+    map_iter_free(iter);
+
+    return size;
+}
+
+static uint64_t list_size(const list *l){
+    uint64_t length = list_get_length(l);
+    uint64_t size = sizeof(limage) + length * sizeof(image_item);
+
+    for (size_t index = 0; index < length; ++index){
+        list_item i;
+
+        list_try_get(l, index, L_TYPE_RESERVED_EMPTY, &i);
+
+        size += payload_size(list_payload(i.type), i.size, i.data);
+    }
+
+    return size;
+}
+
+static void write_bytes(image_writer *w, const void *data, size_t size){
+    if (w->failed || !size){
+        return;
+    }
+
+    if (fwrite(data, 1, size, w->file) != size){
+        log_write(
+            logger,
+            LOG_ERROR,
+            "[%s] write_bytes() - fwrite call failed\n",
+            __FILE__
+        );
+
+        w->failed = true;
+
+        return;
+    }
+
+    w->position += size;
+}
+
+static void write_padding(image_writer *w){
+    static const char zeros[IMAGE_ALIGN] = {0};
+
+    write_bytes(w, zeros, align_size(w->position) - w->position);
+}
+
+static void write_payload(image_writer *w, image_payload payload, size_t size, const void *data){
+    if (payload == PAYLOAD_BYTES){
+        write_bytes(w, data, size);
+        write_bytes(w, "", 1);
+        write_padding(w);
+    }
+    else if (payload == PAYLOAD_LIST){
+        write_list(w, data);
+    }
+    else if (payload == PAYLOAD_MAP){
+        write_map(w, data);
+    }
+}
+
+/* points item (stored at position) at the payload at cursor */
+static void item_set(image_item *item, uint64_t position, uint32_t type, size_t size, image_payload payload, uint64_t cursor){
+    item->type = type;
+    item->reserved = 0;
+    item->size = size;
+    item->offset = payload == PAYLOAD_NONE ? 0 : (int64_t)(cursor - position);
+}
+
+static void write_map(image_writer *w, const map *m){
+    mimage header = {0};
+    header.length = map_get_length(m);
+    header.slotcount = slot_count(header.length);
+
+    if (header.length >= UINT32_MAX){
+        log_write(
+            logger,
+            LOG_ERROR,
+            "[%s] write_map() - map is too large\n",
+            __FILE__
+        );
+
+        w->failed = true;
+
+        return;
+    }
+
+    uint32_t *slots = calloc(header.slotcount, sizeof(*slots));
+    mapiter *iter = map_iter_init(m);
+
+    if (!slots || !iter){
+        log_write(
+            logger,
+            LOG_ERROR,
+            "[%s] write_map() - scratch alloc failed\n",
+            __FILE__
+        );
+
+        free(slots);
+        map_iter_free(iter);
+
+        w->failed = true;
+
+        return;
+    }
+
+    write_bytes(w, &header, sizeof(header));
+
+    uint64_t slotsposition = w->position + header.length * sizeof(image_entry);
+    uint64_t cursor = slotsposition + align_size(header.slotcount * sizeof(*slots));
+
+    for (uint32_t index = 0; map_iter_next(iter); ++index){
+        map_item key, value;
+
+        map_iter_get_key(iter, &key);
+        map_iter_get_value(iter, &value);
+
+        image_entry entry = {0};
+        entry.hash = wyhash(key.data, key.size, IMAGE_HASH_SEED);
+
+        uint64_t mask = header.slotcount - 1;
+        uint64_t slot = entry.hash & mask;
+
+        while (slots[slot]){
+            slot = (slot + 1) & mask;
+        }
+
+        slots[slot] = index + 1;
+
+        uint64_t position = w->position;
+
+        item_set(&entry.key, position + offsetof(image_entry, key), key.type, key.size, PAYLOAD_BYTES, cursor);
+        cursor += payload_size(PAYLOAD_BYTES, key.size, key.data);
+
+        image_payload payload = map_payload(value.type);
+
+        item_set(&entry.value, position + offsetof(image_entry, value), value.type, value.size, payload, cursor);
+        cursor += payload_size(payload, value.size, value.data);
+
+        write_bytes(w, &entry, sizeof(entry));
+    }
+
+    write_bytes(w, slots, header.slotcount * sizeof(*slots));
+    write_padding(w);
+
+    free(slots);
+
+    /* second pass in the same order, so the payloads land where the entries point */
+    map_iter_free(iter);
+
+    iter = map_iter_init(m);
+
+    while (iter && map_iter_next(iter)){
+        map_item key, value;
+
+        map_iter_get_key(iter, &key);
+        map_iter_get_value(iter, &value);
+
+        write_payload(w, PAYLOAD_BYTES, key.size, key.data);
+        write_payload(w, map_payload(value.type), value.size, value.data);
+    }
+
+    map_iter_free(iter);
+
+    if (!w->failed && w->position != cursor){
+        log_write(
+            logger,
+            LOG_ERROR,
+            "[%s] write_map() - payloads did not match the layout\n",
+            __FILE__
+        );
+
+        w->failed = true;
+    }
+}
+
+static void write_list(image_writer *w, const list *l){
+    limage header = {0};
+    header.length = list_get_length(l);
+
+    write_bytes(w, &header, sizeof(header));
+
+    uint64_t cursor = w->position + header.length * sizeof(image_item);
+
+    for (size_t index = 0; index < header.length; ++index){
+        list_item i;
+
+        list_try_get(l, index, L_TYPE_RESERVED_EMPTY, &i);
+
+        image_item item;
+        image_payload payload = list_payload(i.type);
+
+        item_set(&item, w->position, i.type, i.size, payload, cursor);
+        cursor += payload_size(payload, i.size, i.data);
+
+        write_bytes(w, &item, sizeof(item));
+    }
+
+    for (size_t index = 0; index < header.length; ++index){
+        list_item i;
+
+        list_try_get(l, index, L_TYPE_RESERVED_EMPTY, &i);
+
+        write_payload(w, list_payload(i.type), i.size, i.data);
+    }
+}
+
+static bool save(const char *path, image_kind kind, const void *object){
+    FILE *file = fopen(path, "wb");
+
+    if (!file){
+        log_write(
+            logger,
+            LOG_ERROR,
+            "[%s] save() - unable to open %s\n",
+            __FILE__,
+            path
+        );
+
+        return false;
+    }
+
+    image_header header = {0};
+    memcpy(header.magic, IMAGE_MAGIC, IMAGE_MAGIC_SIZE);
+    header.version = IMAGE_VERSION;
+    header.kind = kind;
+    header.size = sizeof(header) + (kind == IMAGE_MAP ? map_size(object) : list_size(object));
+
+    image_writer w = {0};
+    w.file = file;
+
+    write_bytes(&w, &header, sizeof(header));
+
+    if (kind == IMAGE_MAP){
+        write_map(&w, object);
+    }
+    else {
+        write_list(&w, object);
+    }
+
+    if (fclose(file) || (!w.failed && w.position != header.size)){
+        w.failed = true;
+    }
+
+    if (w.failed){
+        log_write(
+            logger,
+            LOG_ERROR,
+            "[%s] save() - unable to write %s\n",
+            __FILE__,
+            path
+        );
+
+        remove(path);
+
+        return false;
+    }
+
+    return true;
+}
+
+static const void *open_image(const char *path, image_kind kind){
+    int fd = open(path, O_RDONLY);
+
+    if (fd < 0){
+        log_write(
+            logger,
+            LOG_ERROR,
+            "[%s] open_image() - unable to open %s\n",
+            __FILE__,
+            path
+        );
+
+        return NULL;
+    }
+
+    struct stat st;
+
+    if (fstat(fd, &st) || (size_t)st.st_size < sizeof(image_header)){
+        log_write(
+            logger,
+            LOG_ERROR,
+            "[%s] open_image() - %s is not an image\n",
+            __FILE__,
+            path
+        );
+
+        close(fd);
+
+        return NULL;
+    }
+
+    void *data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    close(fd);
+
+    if (data == MAP_FAILED){
+        log_write(
+            logger,
+            LOG_ERROR,
+            "[%s] open_image() - mmap call failed\n",
+            __FILE__
+        );
+
+        return NULL;
+    }
+
+    const image_header *header = data;
+
+    if (
+        memcmp(header->magic, IMAGE_MAGIC, IMAGE_MAGIC_SIZE) ||
+        header->version != IMAGE_VERSION ||
+        header->kind != kind ||
+        header->size != (uint64_t)st.st_size
+    ){
+        log_write(
+            logger,
+            LOG_ERROR,
+            "[%s] open_image() - %s has the wrong header\n",
+            __FILE__,
+            path
+        );
+
+        munmap(data, (size_t)st.st_size);
+
+        return NULL;
+    }
+
+    return header + 1;
+}
+
+static void close_image(const void *object){
+    const image_header *header = (const image_header *)object - 1;
+
+    if (memcmp(header->magic, IMAGE_MAGIC, IMAGE_MAGIC_SIZE)){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] close_image() - not the root of an image\n",
+            __FILE__
+        );
+
+        return;
+    }
+
+    munmap((void *)header, header->size);
+}
+
+static const void *item_data(const image_item *item){
+    if (!item->offset){
+        return NULL;
+    }
+
+    return (const char *)item + item->offset;
+}
+
+static const image_entry *find_entry(const mimage *m, size_t size, const void *key){
+    const uint32_t *slots = (const uint32_t *)(m->entries + m->length);
+    uint64_t hash = wyhash(key, size, IMAGE_HASH_SEED);
+    uint64_t mask = m->slotcount - 1;
+
+    for (uint64_t slot = hash & mask; slots[slot]; slot = (slot + 1) & mask){
+        const image_entry *e = m->entries + slots[slot] - 1;
+
+        if (e->hash == hash && e->key.size == size && !memcmp(item_data(&e->key), key, size)){
+            return e;
+        }
+    }
+
+    return NULL;
+}
+
+static const image_item *get_value(const mimage *m, size_t size, const void *key, mtype type){
+    if (!m){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] get_value() - mimage is NULL\n",
+            __FILE__
+        );
+
+        return NULL;
+    }
+    else if (!key){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] get_value() - key is NULL\n",
+            __FILE__
+        );
+
+        return NULL;
+    }
+
+    const image_entry *e = find_entry(m, size, key);
+
+    if (!e){
+        log_write(
+            logger,
+            LOG_DEBUG,
+            "[%s] get_value() - key does not exist\n",
+            __FILE__
+        );
+
+        return NULL;
+    }
+
+    if (type != M_TYPE_RESERVED_EMPTY && e->value.type != (uint32_t)type){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] get_value() - value type does *not* match\n",
+            __FILE__
+        );
+    }
+
+    return &e->value;
+}
+
+static const image_item *get_item(const limage *l, size_t index, ltype type){
+    if (!l){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] get_item() - limage is NULL\n",
+            __FILE__
+        );
+
+        return NULL;
+    }
+    else if (index >= l->length){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] get_item() - index is out of range\n",
+            __FILE__
+        );
+
+        return NULL;
+    }
+
+    const image_item *i = l->items + index;
+
+    if (type != L_TYPE_RESERVED_EMPTY && i->type != (uint32_t)type){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] get_item() - item type does *not* match\n",
+            __FILE__
+        );
+    }
+
+    return i;
+}
+
+bool map_save(const map *m, const char *path){
+    if (!m || !path){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] map_save() - map or path is NULL\n",
+            __FILE__
+        );
+
+        return false;
+    }
+
+    return save(path, IMAGE_MAP, m);
+}
+
+bool list_save(const list *l, const char *path){
+    if (!l || !path){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] list_save() - list or path is NULL\n",
+            __FILE__
+        );
+
+        return false;
+    }
+
+    return save(path, IMAGE_LIST, l);
+}
+
+const mimage *map_mmap(const char *path){
+    if (!path){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] map_mmap() - path is NULL\n",
+            __FILE__
+        );
+
+        return NULL;
+    }
+
+    return open_image(path, IMAGE_MAP);
+}
+
+const limage *list_mmap(const char *path){
+    if (!path){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] list_mmap() - path is NULL\n",
+            __FILE__
+        );
+
+        return NULL;
+    }
+
+    return open_image(path, IMAGE_LIST);
+}
+
+void map_munmap(const mimage *m){
+    if (!m){
+        log_write(
+            logger,
+            LOG_DEBUG,
+            "[%s] map_munmap() - mimage is NULL\n",
+            __FILE__
+        );
+
+        return;
+    }
+
+    close_image(m);
+}
+
+void list_munmap(const limage *l){
+    if (!l){
+        log_write(
+            logger,
+            LOG_DEBUG,
+            "[%s] list_munmap() - limage is NULL\n",
+            __FILE__
+        );
+
+        return;
+    }
+
+    close_image(l);
+}
+
+size_t mimage_get_length(const mimage *m){
+    if (!m){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] mimage_get_length() - mimage is NULL\n",
+            __FILE__
+        );
+
+        return 0;
+    }
+
+    return m->length;
+}
+
+bool mimage_get_entry(const mimage *m, size_t index, map_item *key, map_item *value){
+    if (!m || !key || !value){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] mimage_get_entry() - mimage, key or value is NULL\n",
+            __FILE__
+        );
+
+        return false;
+    }
+    else if (index >= m->length){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] mimage_get_entry() - index is out of range\n",
+            __FILE__
+        );
+
+        return false;
+    }
+
+    const image_entry *e = m->entries + index;
+
+    memset(key, 0, sizeof(*key));
+    key->type = e->key.type;
+    key->size = e->key.size;
+    key->data = (void *)item_data(&e->key);
+
+    memset(value, 0, sizeof(*value));
+    value->type = e->value.type;
+    value->size = e->value.size;
+    value->data = (void *)item_data(&e->value);
+
+    return true;
+}
+
+bool mimage_contains(const mimage *m, size_t size, const void *key){
+    if (!m || !key){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] mimage_contains() - mimage or key is NULL\n",
+            __FILE__
+        );
+
+        return false;
+    }
+
+    return find_entry(m, size, key);
+}
+
+size_t mimage_get_item_size(const mimage *m, size_t size, const void *key){
+    const image_item *i = get_value(m, size, key, M_TYPE_RESERVED_EMPTY);
+
+    if (!i){
+        return 0;
+    }
+
+    return i->size;
+}
+
+mtype mimage_get_type(const mimage *m, size_t size, const void *key){
+    const image_item *i = get_value(m, size, key, M_TYPE_RESERVED_EMPTY);
+
+    if (!i){
+        return M_TYPE_RESERVED_ERROR;
+    }
+
+    return i->type;
+}
+
+bool mimage_get_bool(const mimage *m, size_t size, const void *key){
+    const image_item *i = get_value(m, size, key, M_TYPE_BOOL);
+
+    if (!i){
+        return false;
+    }
+
+    return *(const bool *)item_data(i);
+}
+
+char mimage_get_char(const mimage *m, size_t size, const void *key){
+    const image_item *i = get_value(m, size, key, M_TYPE_CHAR);
+
+    if (!i){
+        return 0;
+    }
+
+    return *(const char *)item_data(i);
+}
+
+double mimage_get_double(const mimage *m, size_t size, const void *key){
+    const image_item *i = get_value(m, size, key, M_TYPE_DOUBLE);
+
+    if (!i){
+        return 0.0;
+    }
+
+    return *(const double *)item_data(i);
+}
+
+int64_t mimage_get_int(const mimage *m, size_t size, const void *key){
+    const image_item *i = get_value(m, size, key, M_TYPE_INT);
+
+    if (!i){
+        return 0;
+    }
+
+    return *(const int64_t *)item_data(i);
+}
+
+uint64_t mimage_get_uint(const mimage *m, size_t size, const void *key){
+    const image_item *i = get_value(m, size, key, M_TYPE_UINT);
+
+    if (!i){
+        return 0;
+    }
+
+    return *(const uint64_t *)item_data(i);
+}
+
+size_t mimage_get_size_t(const mimage *m, size_t size, const void *key){
+    const image_item *i = get_value(m, size, key, M_TYPE_SIZE_T);
+
+    if (!i){
+        return 0;
+    }
+
+    return *(const size_t *)item_data(i);
+}
+
+const char *mimage_get_string(const mimage *m, size_t size, const void *key){
+    const image_item *i = get_value(m, size, key, M_TYPE_STRING);
+
+    if (!i){
+        return NULL;
+    }
+
+    return item_data(i);
+}
+
+const limage *mimage_get_list(const mimage *m, size_t size, const void *key){
+    const image_item *i = get_value(m, size, key, M_TYPE_LIST);
+
+    if (!i){
+        return NULL;
+    }
+
+    return item_data(i);
+}
+
+const mimage *mimage_get_map(const mimage *m, size_t size, const void *key){
+    const image_item *i = get_value(m, size, key, M_TYPE_MAP);
+
+    if (!i){
+        return NULL;
+    }
+
+    return item_data(i);
+}
+
+const void *mimage_get_generic(const mimage *m, size_t size, const void *key){
+    const image_item *i = get_value(m, size, key, M_TYPE_GENERIC);
+
+    if (!i){
+        return NULL;
+    }
+
+    return item_data(i);
+}
+
+size_t limage_get_length(const limage *l){
+    if (!l){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] limage_get_length() - limage is NULL\n",
+            __FILE__
+        );
+
+        return 0;
+    }
+
+    return l->length;
+}
+
+bool limage_get_item(const limage *l, size_t index, list_item *item){
+    if (!item){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] limage_get_item() - item is NULL\n",
+            __FILE__
+        );
+
+        return false;
+    }
+
+    const image_item *i = get_item(l, index, L_TYPE_RESERVED_EMPTY);
+
+    if (!i){
+        return false;
+    }
+
+    memset(item, 0, sizeof(*item));
+    item->type = i->type;
+    item->size = i->size;
+    item->data = (void *)item_data(i);
+
+    return true;
+}
+
+size_t limage_get_item_size(const limage *l, size_t index){
+    const image_item *i = get_item(l, index, L_TYPE_RESERVED_EMPTY);
+
+    if (!i){
+        return 0;
+    }
+
+    return i->size;
+}
+
+ltype limage_get_type(const limage *l, size_t index){
+    const image_item *i = get_item(l, index, L_TYPE_RESERVED_EMPTY);
+
+    if (!i){
+        return L_TYPE_RESERVED_ERROR;
+    }
+
+    return i->type;
+}
+
+bool limage_get_bool(const limage *l, size_t index){
+    const image_item *i = get_item(l, index, L_TYPE_BOOL);
+
+    if (!i){
+        return false;
+    }
+
+    return *(const bool *)item_data(i);
+}
+
+char limage_get_char(const limage *l, size_t index){
+    const image_item *i = get_item(l, index, L_TYPE_CHAR);
+
+    if (!i){
+        return 0;
+    }
+
+    return *(const char *)item_data(i);
+}
+
+double limage_get_double(const limage *l, size_t index){
+    const image_item *i = get_item(l, index, L_TYPE_DOUBLE);
+
+    if (!i){
+        return 0.0;
+    }
+
+    return *(const double *)item_data(i);
+}
+
+int64_t limage_get_int(const limage *l, size_t index){
+    const image_item *i = get_item(l, index, L_TYPE_INT);
+
+    if (!i){
+        return 0;
+    }
+
+    return *(const int64_t *)item_data(i);
+}
+
+uint64_t limage_get_uint(const limage *l, size_t index){
+    const image_item *i = get_item(l, index, L_TYPE_UINT);
+
+    if (!i){
+        return 0;
+    }
+
+    return *(const uint64_t *)item_data(i);
+}
+
+size_t limage_get_size_t(const limage *l, size_t index){
+    const image_item *i = get_item(l, index, L_TYPE_SIZE_T);
+
+    if (!i){
+        return 0;
+    }
+
+    return *(const size_t *)item_data(i);
+}
+
+const char *limage_get_string(const limage *l, size_t index){
+    const image_item *i = get_item(l, index, L_TYPE_STRING);
+
+    if (!i){
+        return NULL;
+    }
+
+    return item_data(i);
+}
+
+const limage *limage_get_list(const limage *l, size_t index){
+    const image_item *i = get_item(l, index, L_TYPE_LIST);
+
+    if (!i){
+        return NULL;
+    }
+
+    return item_data(i);
+}
+
+const mimage *limage_get_map(const limage *l, size_t index){
+    const image_item *i = get_item(l, index, L_TYPE_MAP);
+
+    if (!i){
+        return NULL;
+    }
+
+    return item_data(i);
+}
+
+const void *limage_get_generic(const limage *l, size_t index){
+    const image_item *i = get_item(l, index, L_TYPE_GENERIC);
+
+    if (!i){
+        return NULL;
+    }
+
+    return item_data(i);
+}
@@ -0,0 +1,81 @@
+#ifndef IMAGE_H
+#define IMAGE_H
+
+#include "list.h"
+#include "map.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * binary snapshots of maps and lists. the file holds offsets instead
+ * of pointers (relative to where they are stored) with every string
+ * and scalar inline, so it is mapped as it is and read in place --
+ * opening is O(1) no matter the size and nothing is rebuilt. maps
+ * keep a hash index, nested lists and maps are images themselves.
+ * the format is native endian and generic values are saved as their
+ * raw bytes, so images are meant for the machine that wrote them
+ */
+
+#define IMAGE_VERSION 1
+
+/* a map or list inside a mapped image, read only */
+typedef struct mimage mimage;
+typedef struct limage limage;
+
+bool map_save(const map *, const char *);
+bool list_save(const list *, const char *);
+
+/* only the header is checked, the rest of the file is trusted */
+const mimage *map_mmap(const char *);
+const limage *list_mmap(const char *);
+
+/* takes the image map_mmap/list_mmap returned, not a nested one */
+void map_munmap(const mimage *);
+void list_munmap(const limage *);
+
+size_t mimage_get_length(const mimage *);
+
+/*
+ * entries in the order they were saved. the items point into the
+ * image, nested values are a const mimage/limage and not a map/list
+ */
+bool mimage_get_entry(const mimage *, size_t, map_item *, map_item *);
+
+bool mimage_contains(const mimage *, size_t, const void *);
+size_t mimage_get_item_size(const mimage *, size_t, const void *);
+mtype mimage_get_type(const mimage *, size_t, const void *);
+bool mimage_get_bool(const mimage *, size_t, const void *);
+char mimage_get_char(const mimage *, size_t, const void *);
+double mimage_get_double(const mimage *, size_t, const void *);
+int64_t mimage_get_int(const mimage *, size_t, const void *);
+uint64_t mimage_get_uint(const mimage *, size_t, const void *);
+size_t mimage_get_size_t(const mimage *, size_t, const void *);
+
+/* pointers into the image, valid until it is unmapped */
+const char *mimage_get_string(const mimage *, size_t, const void *);
+const limage *mimage_get_list(const mimage *, size_t, const void *);
+const mimage *mimage_get_map(const mimage *, size_t, const void *);
+const void *mimage_get_generic(const mimage *, size_t, const void *);
+
+size_t limage_get_length(const limage *);
+
+/* same as mimage_get_entry */
+bool limage_get_item(const limage *, size_t, list_item *);
+
+size_t limage_get_item_size(const limage *, size_t);
+ltype limage_get_type(const limage *, size_t);
+bool limage_get_bool(const limage *, size_t);
+char limage_get_char(const limage *, size_t);
+double limage_get_double(const limage *, size_t);
+int64_t limage_get_int(const limage *, size_t);
+uint64_t limage_get_uint(const limage *, size_t);
+size_t limage_get_size_t(const limage *, size_t);
+
+const char *limage_get_string(const limage *, size_t);
+const limage *limage_get_list(const limage *, size_t);
+const mimage *limage_get_map(const limage *, size_t);
+const void *limage_get_generic(const limage *, size_t);
+
+#endif
@@ -0,0 +1,972 @@
+#include "imap.h"
+
+#include "log.h"
+#include "map_item.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define IMAP_MINIMUM_SIZE 8
+#define IMAP_GROWTH_LOAD_FACTOR 0.75
+
+/* 2^64 / golden ratio -- fibonacci hashing, the top bits pick the slot */
+#define IMAP_MULTIPLIER 0x9E3779B97F4A7C15ULL
+
+static logctx *logger = NULL;
+
+typedef struct imap_slot {
+    uint64_t key;
+    mtype type;
+
+    union {
+        bool b;
+        char c;
+        double d;
+        int64_t i;
+        uint64_t u;
+        size_t s;
+        map_item *item;
+    } value;
+} imap_slot;
+
+static bool is_power_of_two(size_t number){
+    return number && !(number & (number - 1));
+}
+
+static bool is_scalar(mtype type){
+    switch (type){
+    case M_TYPE_BOOL:
+    case M_TYPE_CHAR:
+    case M_TYPE_DOUBLE:
+    case M_TYPE_INT:
+    case M_TYPE_UINT:
+    case M_TYPE_SIZE_T:
+        return true;
+    default:
+        return false;
+    }
+}
+
+static size_t scalar_size(mtype type){
+    switch (type){
+    case M_TYPE_BOOL:
+        return sizeof(bool);
+    case M_TYPE_CHAR:
+        return sizeof(char);
+    case M_TYPE_DOUBLE:
+        return sizeof(double);
+    case M_TYPE_INT:
+        return sizeof(int64_t);
+    case M_TYPE_UINT:
+        return sizeof(uint64_t);
+    case M_TYPE_SIZE_T:
+        return sizeof(size_t);
+    default:
+        return 0;
+    }
+}
+
+static unsigned calculate_shift(size_t size){
+    unsigned shift = 64;
+
+    while (size > 1){
+        size >>= 1;
+        --shift;
+    }
+
+    return shift;
+}
+
+static size_t slot_home(const imap *m, uint64_t key){
+    return (key * IMAP_MULTIPLIER) >> m->shift;
+}
+
+static imap_slot *slots_init(size_t size){
+    imap_slot *slots = malloc(size * sizeof(*slots));
+
+    if (!slots){
+        return NULL;
+    }
+
+    for (size_t index = 0; index < size; ++index){
+        slots[index].type = M_TYPE_RESERVED_EMPTY;
+    }
+
+    return slots;
+}
+
+static map_item *item_init(const map_item *value){
+    map_item *i = malloc(sizeof(*i));
+
+    if (!i){
+        log_write(
+            logger,
+            LOG_ERROR,
+            "[%s] item_init() - item alloc failed\n",
+            __FILE__
+        );
+
+        return NULL;
+    }
+
+    if (!map_item_init(i, value)){
+        free(i);
+
+        return NULL;
+    }
+
+    return i;
+}
+
+static void item_free(map_item *i){
+    map_item_free(i);
+
+    free(i);
+}
+
+/* fills slot's type and value from a map_item, taking ownership of value->data */
+static bool slot_init_value(imap_slot *slot, const map_item *value){
+    slot->type = value->type;
+
+    if (is_scalar(value->type)){
+        const void *data = value->data ? value->data : value->data_copy;
+        size_t size = value->size < sizeof(slot->value) ? value->size : sizeof(slot->value);
+
+        slot->value.u = 0;
+
+        if (data){
+            memcpy(&slot->value, data, size);
+        }
+
+        free(value->data);
+    }
+    else if (value->type == M_TYPE_NULL){
+        slot->value.item = NULL;
+    }
+    else {
+        slot->value.item = item_init(value);
+
+        if (!slot->value.item){
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static void slot_free_value(imap_slot *slot){
+    if (!is_scalar(slot->type) && slot->type != M_TYPE_NULL){
+        item_free(slot->value.item);
+    }
+}
+
+static bool find_index(const imap *m, uint64_t key, size_t *ret){
+    size_t mask = m->size - 1;
+    size_t index = slot_home(m, key);
+
+    while (m->slots[index].type != M_TYPE_RESERVED_EMPTY){
+        if (m->slots[index].key == key){
+            *ret = index;
+
+            return true;
+        }
+
+        index = (index + 1) & mask;
+    }
+
+    *ret = index;
+
+    return false;
+}
+
+static bool check_availability(imap *m){
+    double load = (double)(m->length + 1) / (double)m->size;
+
+    if (load > IMAP_GROWTH_LOAD_FACTOR){
+        size_t newsize = m->size << 1;
+
+        if (newsize <= m->size){
+            log_write(
+                logger,
+                LOG_WARNING,
+                "[%s] imap_set() - newsize (%ld) <= m->size (%ld) -- unable to grow imap\n",
+                __FILE__,
+                newsize,
+                m->size
+            );
+
+            return false;
+        }
+
+        if (!imap_resize(m, newsize)){
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static imap_slot *get_slot(const imap *m, uint64_t key, mtype type){
+    if (!m){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] get_slot() - imap is NULL\n",
+            __FILE__
+        );
+
+        return NULL;
+    }
+
+    size_t index;
+
+    if (!find_index(m, key, &index)){
+        log_write(
+            logger,
+            LOG_DEBUG,
+            "[%s] get_slot() - key does not exist\n",
+            __FILE__
+        );
+
+        return NULL;
+    }
+
+    imap_slot *slot = m->slots + index;
+
+    if (type != M_TYPE_RESERVED_EMPTY && slot->type != type){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] get_slot() - slot type does *not* match\n",
+            __FILE__
+        );
+    }
+
+    return slot;
+}
+
+static void *get_pointer(const imap *m, uint64_t key, mtype type){
+    const imap_slot *slot = get_slot(m, key, type);
+
+    if (!slot || is_scalar(slot->type) || slot->type == M_TYPE_NULL){
+        return NULL;
+    }
+
+    return slot->value.item->data;
+}
+
+/* linear probing backward shift -- no tombstones are left behind */
+static void erase_index(imap *m, size_t index){
+    size_t mask = m->size - 1;
+    size_t next = index;
+
+    while (true){
+        next = (next + 1) & mask;
+
+        if (m->slots[next].type == M_TYPE_RESERVED_EMPTY){
+            break;
+        }
+
+        size_t home = slot_home(m, m->slots[next].key);
+
+        /* leave entries whose home lies cyclically in (index, next] */
+        if (index <= next ? (index < home && home <= next) : (index < home || home <= next)){
+            continue;
+        }
+
+        m->slots[index] = m->slots[next];
+        index = next;
+    }
+
+    m->slots[index].type = M_TYPE_RESERVED_EMPTY;
+
+    --m->length;
+}
+
+imap *imap_init(void){
+    if (!is_power_of_two(IMAP_MINIMUM_SIZE)){
+        log_write(
+            logger,
+            LOG_ERROR,
+            "[%s] imap_init() - IMAP_MINIMUM_SIZE must be a power of 2\n",
+            __FILE__
+        );
+
+        return NULL;
+    }
+
+    imap *m = malloc(sizeof(*m));
+
+    if (!m){
+        log_write(
+            logger,
+            LOG_ERROR,
+            "[%s] imap_init() - imap alloc failed\n",
+            __FILE__
+        );
+
+        return NULL;
+    }
+
+    m->length = 0;
+    m->size = IMAP_MINIMUM_SIZE;
+    m->shift = calculate_shift(m->size);
+    m->slots = slots_init(m->size);
+
+    if (!m->slots){
+        log_write(
+            logger,
+            LOG_ERROR,
+            "[%s] imap_init() - slots alloc failed\n",
+            __FILE__
+        );
+
+        free(m);
+
+        return NULL;
+    }
+
+    return m;
+}
+
+imap *imap_copy(const imap *m){
+    if (!m){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] imap_copy() - imap is NULL\n",
+            __FILE__
+        );
+
+        return NULL;
+    }
+
+    imap *copy = imap_init();
+
+    if (!copy){
+        log_write(
+            logger,
+            LOG_ERROR,
+            "[%s] imap_copy() - imap initialization failed\n",
+            __FILE__
+        );
+
+        return NULL;
+    }
+
+    if (!imap_resize(copy, m->size)){
+        log_write(
+            logger,
+            LOG_ERROR,
+            "[%s] imap_copy() - imap_resize call failed\n",
+            __FILE__
+        );
+
+        imap_free(copy);
+
+        return NULL;
+    }
+
+    /* same size and shift so slots copy over as they are */
+    for (size_t index = 0; index < m->size; ++index){
+        imap_slot *slot = copy->slots + index;
+
+        *slot = m->slots[index];
+
+        if (!is_scalar(slot->type) && slot->type != M_TYPE_NULL && slot->type != M_TYPE_RESERVED_EMPTY){
+            map_item value = *slot->value.item;
+            value.data = NULL;
+            value.data_copy = slot->value.item->data;
+
+            slot->value.item = item_init(&value);
+
+            if (!slot->value.item){
+                log_write(
+                    logger,
+                    LOG_ERROR,
+                    "[%s] imap_copy() - item copy failed\n",
+                    __FILE__
+                );
+
+                slot->type = M_TYPE_RESERVED_EMPTY;
+
+                imap_free(copy);
+
+                return NULL;
+            }
+        }
+
+        if (slot->type != M_TYPE_RESERVED_EMPTY){
+            ++copy->length;
+        }
+    }
+
+    return copy;
+}
+
+bool imap_resize(imap *m, size_t size){
+    if (!m){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] imap_resize() - imap is NULL\n",
+            __FILE__
+        );
+
+        return false;
+    }
+    else if (size < IMAP_MINIMUM_SIZE){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] imap_resize() - size cannot be less than IMAP_MINIMUM_SIZE -- set to IMAP_MINIMUM_SIZE (%d)\n",
+            __FILE__,
+            IMAP_MINIMUM_SIZE
+        );
+
+        size = IMAP_MINIMUM_SIZE;
+    }
+    else if (!is_power_of_two(size)){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] imap_resize() - size must be a power of 2\n",
+            __FILE__
+        );
+
+        return false;
+    }
+
+    if ((double)m->length / (double)size > IMAP_GROWTH_LOAD_FACTOR){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] imap_resize() - size (%ld) is too small for imap length (%ld)\n",
+            __FILE__,
+            size,
+            m->length
+        );
+
+        return false;
+    }
+
+    imap_slot *slots = slots_init(size);
+
+    if (!slots){
+        log_write(
+            logger,
+            LOG_ERROR,
+            "[%s] imap_resize() - slots alloc failed\n",
+            __FILE__
+        );
+
+        return false;
+    }
+
+    imap_slot *old = m->slots;
+    size_t oldsize = m->size;
+
+    m->slots = slots;
+    m->size = size;
+    m->shift = calculate_shift(size);
+
+    for (size_t index = 0; index < oldsize; ++index){
+        if (old[index].type == M_TYPE_RESERVED_EMPTY){
+            continue;
+        }
+
+        size_t newindex;
+
+        find_index(m, old[index].key, &newindex);
+
+        m->slots[newindex] = old[index];
+    }
+
+    free(old);
+
+    return true;
+}
+
+size_t imap_get_length(const imap *m){
+    if (!m){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] imap_get_length() - imap is NULL\n",
+            __FILE__
+        );
+
+        return 0;
+    }
+
+    return m->length;
+}
+
+size_t imap_get_size(const imap *m){
+    if (!m){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] imap_get_size() - imap is NULL\n",
+            __FILE__
+        );
+
+        return 0;
+    }
+
+    return m->size;
+}
+
+imapiter *imap_iter_init(const imap *m){
+    if (!m){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] imap_iter_init() - imap is NULL\n",
+            __FILE__
+        );
+
+        return NULL;
+    }
+
+    imapiter *iter = malloc(sizeof(*iter));
+
+    if (!iter){
+        log_write(
+            logger,
+            LOG_ERROR,
+            "[%s] imap_iter_init() - iterator alloc failed\n",
+            __FILE__
+        );
+
+        return NULL;
+    }
+
+    iter->m = m;
+    iter->index = m->size;
+
+    return iter;
+}
+
+bool imap_iter_get_key(const imapiter *iter, uint64_t *key){
+    if (!iter || !key){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] imap_iter_get_key() - iterator or key is NULL\n",
+            __FILE__
+        );
+
+        return false;
+    }
+    else if (iter->index >= iter->m->size){
+        log_write(
+            logger,
+            LOG_DEBUG,
+            "[%s] imap_iter_get_key() - imap_iter_next hasn't been called or imap is empty\n",
+            __FILE__
+        );
+
+        return false;
+    }
+
+    *key = iter->m->slots[iter->index].key;
+
+    return true;
+}
+
+/* scalar data points into the slot -- valid until the imap is modified */
+bool imap_iter_get_value(const imapiter *iter, map_item *value){
+    if (!iter || !value){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] imap_iter_get_value() - iterator or value is NULL\n",
+            __FILE__
+        );
+
+        return false;
+    }
+    else if (iter->index >= iter->m->size){
+        log_write(
+            logger,
+            LOG_DEBUG,
+            "[%s] imap_iter_get_value() - imap_iter_next hasn't been called or imap is empty\n",
+            __FILE__
+        );
+
+        return false;
+    }
+
+    imap_slot *slot = iter->m->slots + iter->index;
+
+    if (is_scalar(slot->type) || slot->type == M_TYPE_NULL){
+        value->type = slot->type;
+        value->size = scalar_size(slot->type);
+        value->data = slot->type == M_TYPE_NULL ? NULL : &slot->value;
+        value->data_copy = NULL;
+        value->generic_free = NULL;
+    }
+    else {
+        *value = *slot->value.item;
+    }
+
+    return true;
+}
+
+bool imap_iter_next(imapiter *iter){
+    if (!iter){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] imap_iter_next() - iterator is NULL\n",
+            __FILE__
+        );
+
+        return false;
+    }
+
+    const imap *m = iter->m;
+    size_t index = iter->index >= m->size ? 0 : iter->index + 1;
+
+    while (index < m->size && m->slots[index].type == M_TYPE_RESERVED_EMPTY){
+        ++index;
+    }
+
+    iter->index = index;
+
+    return index < m->size;
+}
+
+void imap_iter_free(imapiter *iter){
+    if (!iter){
+        log_write(
+            logger,
+            LOG_DEBUG,
+            "[%s] imap_iter_free() - iterator is NULL\n",
+            __FILE__
+        );
+
+        return;
+    }
+
+    free(iter);
+}
+
+bool imap_contains(const imap *m, uint64_t key){
+    return get_slot(m, key, M_TYPE_RESERVED_EMPTY);
+}
+
+mtype imap_get_type(const imap *m, uint64_t key){
+    const imap_slot *slot = get_slot(m, key, M_TYPE_RESERVED_EMPTY);
+
+    if (!slot){
+        return M_TYPE_RESERVED_ERROR;
+    }
+
+    return slot->type;
+}
+
+bool imap_get_bool(const imap *m, uint64_t key){
+    const imap_slot *slot = get_slot(m, key, M_TYPE_BOOL);
+
+    if (!slot){
+        return false;
+    }
+
+    return slot->value.b;
+}
+
+char imap_get_char(const imap *m, uint64_t key){
+    const imap_slot *slot = get_slot(m, key, M_TYPE_CHAR);
+
+    if (!slot){
+        return 0;
+    }
+
+    return slot->value.c;
+}
+
+double imap_get_double(const imap *m, uint64_t key){
+    const imap_slot *slot = get_slot(m, key, M_TYPE_DOUBLE);
+
+    if (!slot){
+        return 0.0;
+    }
+
+    return slot->value.d;
+}
+
+int64_t imap_get_int(const imap *m, uint64_t key){
+    const imap_slot *slot = get_slot(m, key, M_TYPE_INT);
+
+    if (!slot){
+        return 0;
+    }
+
+    return slot->value.i;
+}
+
+uint64_t imap_get_uint(const imap *m, uint64_t key){
+    const imap_slot *slot = get_slot(m, key, M_TYPE_UINT);
+
+    if (!slot){
+        return 0;
+    }
+
+    return slot->value.u;
+}
+
+size_t imap_get_size_t(const imap *m, uint64_t key){
+    const imap_slot *slot = get_slot(m, key, M_TYPE_SIZE_T);
+
+    if (!slot){
+        return 0;
+    }
+
+    return slot->value.s;
+}
+
+/*
+ * READ WARNING FOR THESE FUNCTIONS IN MAP HEADER FILE
+ */
+char *imap_get_string(const imap *m, uint64_t key){
+    return get_pointer(m, key, M_TYPE_STRING);
+}
+
+list *imap_get_list(const imap *m, uint64_t key){
+    return get_pointer(m, key, M_TYPE_LIST);
+}
+
+map *imap_get_map(const imap *m, uint64_t key){
+    return get_pointer(m, key, M_TYPE_MAP);
+}
+
+void *imap_get_generic(const imap *m, uint64_t key){
+    return get_pointer(m, key, M_TYPE_GENERIC);
+}
+
+bool imap_set(imap *m, uint64_t key, const map_item *value){
+    if (!m){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] imap_set() - imap is NULL\n",
+            __FILE__
+        );
+
+        return false;
+    }
+    else if (!value){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] imap_set() - value is NULL\n",
+            __FILE__
+        );
+
+        return false;
+    }
+
+    size_t index;
+
+    if (find_index(m, key, &index)){
+        imap_slot tmp = {0};
+
+        if (!slot_init_value(&tmp, value)){
+            log_write(
+                logger,
+                LOG_ERROR,
+                "[%s] imap_set() - value initialization failed\n",
+                __FILE__
+            );
+
+            return false;
+        }
+
+        slot_free_value(m->slots + index);
+
+        m->slots[index].type = tmp.type;
+        m->slots[index].value = tmp.value;
+
+        return true;
+    }
+
+    if (!check_availability(m)){
+        log_write(
+            logger,
+            LOG_ERROR,
+            "[%s] imap_set() - check_availability call failed\n",
+            __FILE__
+        );
+
+        return false;
+    }
+
+    find_index(m, key, &index);
+
+    imap_slot *slot = m->slots + index;
+
+    if (!slot_init_value(slot, value)){
+        log_write(
+            logger,
+            LOG_ERROR,
+            "[%s] imap_set() - value initialization failed\n",
+            __FILE__
+        );
+
+        slot->type = M_TYPE_RESERVED_EMPTY;
+
+        return false;
+    }
+
+    slot->key = key;
+
+    ++m->length;
+
+    return true;
+}
+
+bool imap_set_bool(imap *m, uint64_t key, bool value){
+    map_item item = {0};
+    item.type = M_TYPE_BOOL;
+    item.size = sizeof(value);
+    item.data_copy = &value;
+
+    return imap_set(m, key, &item);
+}
+
+bool imap_set_char(imap *m, uint64_t key, char value){
+    map_item item = {0};
+    item.type = M_TYPE_CHAR;
+    item.size = sizeof(value);
+    item.data_copy = &value;
+
+    return imap_set(m, key, &item);
+}
+
+bool imap_set_double(imap *m, uint64_t key, double value){
+    map_item item = {0};
+    item.type = M_TYPE_DOUBLE;
+    item.size = sizeof(value);
+    item.data_copy = &value;
+
+    return imap_set(m, key, &item);
+}
+
+bool imap_set_int(imap *m, uint64_t key, int64_t value){
+    map_item item = {0};
+    item.type = M_TYPE_INT;
+    item.size = sizeof(value);
+    item.data_copy = &value;
+
+    return imap_set(m, key, &item);
+}
+
+bool imap_set_uint(imap *m, uint64_t key, uint64_t value){
+    map_item item = {0};
+    item.type = M_TYPE_UINT;
+    item.size = sizeof(value);
+    item.data_copy = &value;
+
+    return imap_set(m, key, &item);
+}
+
+bool imap_set_size_t(imap *m, uint64_t key, size_t value){
+    map_item item = {0};
+    item.type = M_TYPE_SIZE_T;
+    item.size = sizeof(value);
+    item.data_copy = &value;
+
+    return imap_set(m, key, &item);
+}
+
+void imap_pop(imap *m, uint64_t key, map_item *value){
+    imap_slot *slot = get_slot(m, key, M_TYPE_RESERVED_EMPTY);
+
+    if (!slot){
+        return;
+    }
+
+    if (!value){
+        log_write(
+            logger,
+            LOG_DEBUG,
+            "[%s] imap_pop() - value is NULL -- removing but unable to assign\n",
+            __FILE__
+        );
+
+        slot_free_value(slot);
+    }
+    else if (is_scalar(slot->type)){
+        /* scalars live in the slot -- hand back a copy the caller owns like map_pop */
+        value->type = slot->type;
+        value->size = scalar_size(slot->type);
+        value->data = malloc(value->size);
+        value->data_copy = NULL;
+        value->generic_free = NULL;
+
+        if (value->data){
+            memcpy(value->data, &slot->value, value->size);
+        }
+        else {
+            log_write(
+                logger,
+                LOG_ERROR,
+                "[%s] imap_pop() - value alloc failed\n",
+                __FILE__
+            );
+
+            value->type = M_TYPE_NULL;
+            value->size = 0;
+        }
+    }
+    else if (slot->type == M_TYPE_NULL){
+        value->type = M_TYPE_NULL;
+        value->size = 0;
+        value->data = NULL;
+        value->data_copy = NULL;
+        value->generic_free = NULL;
+    }
+    else {
+        *value = *slot->value.item;
+
+        free(slot->value.item);
+    }
+
+    erase_index(m, slot - m->slots);
+}
+
+void imap_remove(imap *m, uint64_t key){
+    imap_slot *slot = get_slot(m, key, M_TYPE_RESERVED_EMPTY);
+
+    if (!slot){
+        return;
+    }
+
+    slot_free_value(slot);
+    erase_index(m, slot - m->slots);
+}
+
+void imap_free(imap *m){
+    if (!m){
+        log_write(
+            logger,
+            LOG_DEBUG,
+            "[%s] imap_free() - imap is NULL\n",
+            __FILE__
+        );
+
+        return;
+    }
+
+    for (size_t index = 0; index < m->size; ++index){
+        if (m->slots[index].type != M_TYPE_RESERVED_EMPTY){
+            slot_free_value(m->slots + index);
+        }
+    }
+
+    free(m->slots);
+    free(m);
+}
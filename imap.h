@@ -0,0 +1,70 @@
+#ifndef IMAP_H
+#define IMAP_H
+
+#include "map.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * integer keyed map. keys and scalar values (bool, char, double,
+ * int, uint, size_t) live inline in the slot so setting them does
+ * no allocation. other values are stored as a map_item
+ */
+
+typedef struct imap_slot imap_slot;
+
+typedef struct imap {
+    imap_slot *slots;
+    size_t length;
+    size_t size;
+    unsigned shift;
+} imap;
+
+typedef struct imapiter {
+    const imap *m;
+    size_t index;
+} imapiter;
+
+imap *imap_init(void);
+imap *imap_copy(const imap *);
+bool imap_resize(imap *, size_t);
+
+size_t imap_get_length(const imap *);
+size_t imap_get_size(const imap *);
+
+imapiter *imap_iter_init(const imap *);
+bool imap_iter_get_key(const imapiter *, uint64_t *);
+bool imap_iter_get_value(const imapiter *, map_item *);
+bool imap_iter_next(imapiter *);
+void imap_iter_free(imapiter *);
+
+bool imap_contains(const imap *, uint64_t);
+mtype imap_get_type(const imap *, uint64_t);
+bool imap_get_bool(const imap *, uint64_t);
+char imap_get_char(const imap *, uint64_t);
+double imap_get_double(const imap *, uint64_t);
+int64_t imap_get_int(const imap *, uint64_t);
+uint64_t imap_get_uint(const imap *, uint64_t);
+size_t imap_get_size_t(const imap *, uint64_t);
+
+/* see the warning in map.h -- the same applies here */
+char *imap_get_string(const imap *, uint64_t);
+list *imap_get_list(const imap *, uint64_t);
+map *imap_get_map(const imap *, uint64_t);
+void *imap_get_generic(const imap *, uint64_t);
+
+bool imap_set(imap *, uint64_t, const map_item *);
+bool imap_set_bool(imap *, uint64_t, bool);
+bool imap_set_char(imap *, uint64_t, char);
+bool imap_set_double(imap *, uint64_t, double);
+bool imap_set_int(imap *, uint64_t, int64_t);
+bool imap_set_uint(imap *, uint64_t, uint64_t);
+bool imap_set_size_t(imap *, uint64_t, size_t);
+
+void imap_pop(imap *, uint64_t, map_item *);
+void imap_remove(imap *, uint64_t);
+void imap_free(imap *);
+
+#endif
@@ -5,10 +5,19 @@
 
 #include <stdbool.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 static logctx *logger = NULL;
 
+/* holds a converted scalar until map_from_arrays copies it */
+typedef union json_scalar {
+    bool boolean;
+    double number;
+    int64_t integer;
+    const char *string;
+} json_scalar;
+
 list *json_array_to_list(json_object *value){
     if (!value || json_object_get_type(value) != json_type_array){
         log_write(
@@ -274,39 +283,46 @@ map *json_to_map(json_object *json){
         return NULL;
     }
 
-    map *m = map_init();
+    size_t count = json_object_object_length(json);
 
-    if (!m){
+    /* keys in the first half, values in the second */
+    map_item *items = calloc(count * 2 + 1, sizeof(*items));
+    json_scalar *scalars = calloc(count + 1, sizeof(*scalars));
+
+    if (!items || !scalars){
         log_write(
             logger,
             LOG_ERROR,
-            "[%s] json_to_map() - map initialization failed\n",
+            "[%s] json_to_map() - items alloc failed\n",
             __FILE__
         );
 
+        free(items);
+        free(scalars);
+
         return NULL;
     }
 
+    map_item *keys = items;
+    map_item *values = items + count;
+
     struct json_object_iterator curr = json_object_iter_begin(json);
     struct json_object_iterator end = json_object_iter_end(json);
 
-    while (!json_object_iter_equal(&curr, &end)){
+    for (size_t index = 0; index < count && !json_object_iter_equal(&curr, &end); ++index){
         const char *key = json_object_iter_peek_name(&curr);
         json_object *valueobj = json_object_iter_peek_value(&curr);
         json_type type = json_object_get_type(valueobj);
 
-        map_item k = {0};
-        k.type = M_TYPE_STRING;
-        k.size = strlen(key);
-        k.data_copy = key;
+        map_item *k = keys + index;
+        k->type = M_TYPE_STRING;
+        k->size = strlen(key);
+        k->data_copy = key;
 
-        map_item v = {0};
+        map_item *v = values + index;
+        json_scalar *scalar = scalars + index;
 
         list *listvalue = NULL;
-        bool boolvalue = false;
-        double doublevalue = 0.0;
-        int64_t intvalue = 0;
-        const char *strvalue = NULL;
         map *mapvalue = NULL;
 
         switch (type){
@@ -324,41 +340,41 @@ map *json_to_map(json_object *json){
                 break;
             }
 
-            v.type = M_TYPE_LIST;
-            v.size = sizeof(*listvalue);
-            v.data = listvalue;
+            v->type = M_TYPE_LIST;
+            v->size = sizeof(*listvalue);
+            v->data = listvalue;
 
             break;
         case json_type_boolean:
-            boolvalue = json_object_get_boolean(valueobj);
+            scalar->boolean = json_object_get_boolean(valueobj);
 
-            v.type = M_TYPE_BOOL;
-            v.size = sizeof(boolvalue);
-            v.data_copy = &boolvalue;
+            v->type = M_TYPE_BOOL;
+            v->size = sizeof(scalar->boolean);
+            v->data_copy = &scalar->boolean;
 
             break;
         case json_type_double:
-            doublevalue = json_object_get_double(valueobj);
+            scalar->number = json_object_get_double(valueobj);
 
-            v.type = M_TYPE_DOUBLE;
-            v.size = sizeof(doublevalue);
-            v.data_copy = &doublevalue;
+            v->type = M_TYPE_DOUBLE;
+            v->size = sizeof(scalar->number);
+            v->data_copy = &scalar->number;
 
             break;
         case json_type_int:
-            intvalue = json_object_get_int64(valueobj);
+            scalar->integer = json_object_get_int64(valueobj);
 
-            v.type = M_TYPE_INT;
-            v.size = sizeof(intvalue);
-            v.data_copy = &intvalue;
+            v->type = M_TYPE_INT;
+            v->size = sizeof(scalar->integer);
+            v->data_copy = &scalar->integer;
 
             break;
         case json_type_null:
-            strvalue = NULL;
+            scalar->string = NULL;
 
-            v.type = M_TYPE_NULL;
-            v.size = sizeof(strvalue);
-            v.data_copy = &strvalue;
+            v->type = M_TYPE_NULL;
+            v->size = sizeof(scalar->string);
+            v->data_copy = &scalar->string;
 
             break;
         case json_type_object:
@@ -375,17 +391,17 @@ map *json_to_map(json_object *json){
                 break;
             }
 
-            v.type = M_TYPE_MAP;
-            v.size = sizeof(*mapvalue);
-            v.data = mapvalue;
+            v->type = M_TYPE_MAP;
+            v->size = sizeof(*mapvalue);
+            v->data = mapvalue;
 
             break;
         case json_type_string:
-            strvalue = json_object_get_string(valueobj);
+            scalar->string = json_object_get_string(valueobj);
 
-            v.type = M_TYPE_STRING;
-            v.size = strlen(strvalue);
-            v.data_copy = strvalue;
+            v->type = M_TYPE_STRING;
+            v->size = strlen(scalar->string);
+            v->data_copy = scalar->string;
 
             break;
         default:
@@ -398,30 +414,28 @@ map *json_to_map(json_object *json){
             );
         }
 
-        if (!map_set(m, &k, &v)){
-            log_write(
-                logger,
-                LOG_ERROR,
-                "[%s] json_to_map() - failed to add key: %s\n",
-                __FILE__,
-                key
-            );
-
-            if (listvalue){
-                list_free(listvalue);
-            }
-            else if (mapvalue){
-                map_free(mapvalue);
-            }
+        json_object_iter_next(&curr);
+    }
 
-            map_free(m);
+    map_options options = {0};
+    options.arena = true;
+    options.atoms = true;
 
-            return NULL;
-        }
+    /* sized once up front -- on failure it also frees the lists and maps handed over */
+    map *m = map_from_arrays(&options, count, keys, values);
 
-        json_object_iter_next(&curr);
+    if (!m){
+        log_write(
+            logger,
+            LOG_ERROR,
+            "[%s] json_to_map() - map_from_arrays call failed\n",
+            __FILE__
+        );
     }
 
+    free(items);
+    free(scalars);
+
     return m;
 }
 
@@ -39,202 +39,302 @@ static bool check_availability(list *l){
     return true;
 }
 
-static list_item *item_init_pointer(ltype type, size_t size, void *data, list_generic_free generic_free){
-    list_item *i = malloc(sizeof(*i));
+/* a generic item with its own free function -- the cell only has room for the pointer */
+typedef struct list_generic {
+    void *data;
+    list_generic_free generic_free;
+} list_generic;
 
-    if (!i){
-        log_write(
-            logger,
-            LOG_ERROR,
-            "[%s] item_init_pointer() - item object alloc failed\n",
-            __FILE__
-        );
+/*
+ * scalars up to 8 bytes are stored in value itself, everything else is
+ * a pointer to the payload. nothing points back into a cell so cells
+ * can be moved with memmove and realloc
+ */
+typedef union list_value {
+    bool b;
+    char c;
+    double d;
+    int64_t i;
+    uint64_t u;
+    size_t z;
+    void *data;
+} list_value;
+
+struct list_cell {
+    list_value value;
+    size_t size;
+    uint8_t type;
+    bool inlined;
+    bool boxed;
+};
+
+static bool cell_is_inlinable(ltype type, size_t size){
+    switch (type){
+    case L_TYPE_BOOL:
+    case L_TYPE_CHAR:
+    case L_TYPE_DOUBLE:
+    case L_TYPE_INT:
+    case L_TYPE_UINT:
+    case L_TYPE_SIZE_T:
+        return size <= sizeof(list_value);
+    default:
+        return false;
+    }
+}
 
-        return NULL;
+static void *cell_get_data(const list_cell *c){
+    if (c->inlined){
+        return (void *)&c->value;
+    }
+    else if (c->boxed){
+        return ((list_generic *)c->value.data)->data;
     }
 
-    i->type = type;
-    i->size = size;
-    i->data = data;
-    i->generic_free = generic_free;
+    return c->value.data;
+}
 
-    return i;
+/* the item handed out for a cell -- data points into the list */
+static void cell_view(const list_cell *c, list_item *item){
+    item->type = c->type;
+    item->size = c->size;
+    item->data = cell_get_data(c);
+    item->data_copy = NULL;
+    item->generic_free = c->boxed ? ((list_generic *)c->value.data)->generic_free : NULL;
 }
 
-static list_item *item_init(ltype type, size_t size, const void *data, list_generic_free generic_free){
-    list_item *i = malloc(sizeof(*i));
+static bool cell_set_pointer(list_cell *c, void *data, list_generic_free generic_free){
+    c->value.data = data;
 
-    if (!i){
+    if (c->type != L_TYPE_GENERIC || !generic_free){
+        return true;
+    }
+
+    list_generic *box = malloc(sizeof(*box));
+
+    if (!box){
         log_write(
             logger,
             LOG_ERROR,
-            "[%s] item_init() - item object alloc failed\n",
+            "[%s] cell_set_pointer() - generic box alloc failed\n",
             __FILE__
         );
 
-        return NULL;
+        return false;
     }
 
-    i->type = type;
-    i->size = size;
-    i->generic_free = generic_free;
+    box->data = data;
+    box->generic_free = generic_free;
 
-    if (type == L_TYPE_LIST){
-        i->data = list_copy(data);
+    c->value.data = box;
+    c->boxed = true;
 
-        if (!i->data){
+    return true;
+}
+
+static bool cell_init_pointer(list_cell *c, ltype type, size_t size, void *data, list_generic_free generic_free){
+    c->type = type;
+    c->size = size;
+    c->inlined = false;
+    c->boxed = false;
+
+    return cell_set_pointer(c, data, generic_free);
+}
+
+static bool cell_init(list_cell *c, ltype type, size_t size, const void *data, list_generic_free generic_free){
+    c->type = type;
+    c->size = size;
+    c->inlined = false;
+    c->boxed = false;
+
+    void *copy = NULL;
+
+    if (cell_is_inlinable(type, size)){
+        c->inlined = true;
+        c->value.u = 0;
+
+        memcpy(&c->value, data, size);
+
+        return true;
+    }
+    else if (type == L_TYPE_LIST){
+        copy = list_copy(data);
+
+        if (!copy){
             log_write(
                 logger,
                 LOG_ERROR,
-                "[%s] item_init() - list_copy call failed\n",
+                "[%s] cell_init() - list_copy call failed\n",
                 __FILE__
             );
 
-            free(i);
-
-            return NULL;
+            return false;
         }
     }
     else if (type == L_TYPE_MAP){
-        i->data = map_copy(data);
+        copy = map_copy(data);
 
-        if (!i->data){
+        if (!copy){
             log_write(
                 logger,
                 LOG_ERROR,
-                "[%s] item_init() - map_copy call failed\n",
+                "[%s] cell_init() - map_copy call failed\n",
                 __FILE__
             );
 
-            free(i);
-
-            return NULL;
+            return false;
         }
     }
-    else if (type == L_TYPE_NULL){
-        i->data = NULL;
-    }
     else if (type == L_TYPE_STRING){
-        i->data = malloc(size + 1);
+        copy = malloc(size + 1);
 
-        if (!i->data){
+        if (!copy){
             log_write(
                 logger,
                 LOG_ERROR,
-                "[%s] item_init() - item string alloc failed\n",
+                "[%s] cell_init() - item string alloc failed\n",
                 __FILE__
             );
 
-            free(i);
-
-            return NULL;
+            return false;
         }
 
-        string_copy(data, i->data, size);
+        memcpy(copy, data, size);
+
+        ((char *)copy)[size] = '\0';
     }
-    else {
-        i->data = malloc(size);
+    else if (type != L_TYPE_NULL){
+        copy = malloc(size);
 
-        if (!i->data){
+        if (!copy){
             log_write(
                 logger,
                 LOG_ERROR,
-                "[%s] item_init() - item data alloc failed\n",
+                "[%s] cell_init() - item data alloc failed\n",
                 __FILE__
             );
 
-            free(i);
-
-            return NULL;
+            return false;
         }
 
-        memcpy(i->data, data, size);
+        memcpy(copy, data, size);
     }
 
-    return i;
+    if (!cell_set_pointer(c, copy, generic_free)){
+        free(copy);
+
+        return false;
+    }
+
+    return true;
 }
 
-static void item_free(list_item *i){
-    if (!i){
-        log_write(
-            logger,
-            LOG_ERROR,
-            "[%s] item_free() - item should *not* be NULL\n",
-            __FILE__
+static bool cell_init_item(list_cell *c, const list_item *item){
+    if (item->data){
+        return cell_init_pointer(
+            c,
+            item->type,
+            item->size,
+            item->data,
+            item->generic_free
         );
+    }
+
+    return cell_init(
+        c,
+        item->type,
+        item->size,
+        item->data_copy,
+        item->generic_free
+    );
+}
 
+static void cell_free(list_cell *c){
+    if (c->inlined){
         return;
     }
 
-    switch (i->type){
+    void *data = cell_get_data(c);
+
+    switch (c->type){
     case L_TYPE_GENERIC:
-        if (i->generic_free){
-            i->generic_free(i->data);
+        if (c->boxed){
+            ((list_generic *)c->value.data)->generic_free(data);
+
+            free(c->value.data);
         }
         else {
-            free(i->data);
+            free(data);
         }
 
         break;
     case L_TYPE_LIST:
-        list_free(i->data);
+        list_free(data);
 
         break;
     case L_TYPE_MAP:
-        map_free(i->data);
+        map_free(data);
 
         break;
     case L_TYPE_NULL:
         break;
     default:
-        free(i->data);
+        free(data);
     }
-
-    free(i);
 }
 
-static list_item *get_item(const list *l, size_t pos, ltype type){
-    if (!l){
-        log_write(
-            logger,
-            LOG_WARNING,
-            "[%s] get_list_item() - list is NULL\n",
-            __FILE__
-        );
+static lstatus try_get_cell(const list *l, size_t pos, ltype type, const list_cell **cell){
+    const list_cell *c = NULL;
+    lstatus status = L_STATUS_OK;
 
-        return NULL;
+    if (!l){
+        status = L_STATUS_INVALID;
     }
     else if (pos >= l->length){
+        status = L_STATUS_OUT_OF_RANGE;
+    }
+    else {
+        c = l->cells + pos;
+
+        if (type != L_TYPE_RESERVED_EMPTY && c->type != type){
+            status = L_STATUS_TYPE_MISMATCH;
+        }
+    }
+
+    *cell = c;
+
+    return status;
+}
+
+static list_cell *get_cell(const list *l, size_t pos, ltype type){
+    const list_cell *c = NULL;
+    lstatus status = try_get_cell(l, pos, type, &c);
+
+    if (status == L_STATUS_INVALID){
         log_write(
             logger,
             LOG_WARNING,
-            "[%s] get_list_item() - position out of range\n",
+            "[%s] get_cell() - list is NULL or unable to get item\n",
             __FILE__
         );
-
-        return NULL;
     }
-
-    list_item *i = l->items[pos];
-
-    if (!i){
+    else if (status == L_STATUS_OUT_OF_RANGE){
         log_write(
             logger,
             LOG_WARNING,
-            "[%s] get_list_item() - unable to get item\n",
+            "[%s] get_cell() - position out of range\n",
             __FILE__
         );
     }
-    else if (type != L_TYPE_RESERVED_EMPTY && i->type != type){
+    else if (status == L_STATUS_TYPE_MISMATCH){
         log_write(
             logger,
             LOG_WARNING,
-            "[%s] get_list_item() - item type does *not* match!\n",
+            "[%s] get_cell() - item type does *not* match!\n",
             __FILE__
         );
     }
 
-    return i;
+    return (list_cell *)c;
 }
 
 list *list_init(void){
@@ -264,13 +364,13 @@ list *list_init(void){
 
     l->length = 0;
     l->size = LIST_MINIMUM_SIZE;
-    l->items = calloc(l->size, sizeof(*l->items));
+    l->cells = calloc(l->size, sizeof(*l->cells));
 
-    if (!l->items){
+    if (!l->cells){
         log_write(
             logger,
             LOG_ERROR,
-            "[%s] list_init() - items object alloc failed\n",
+            "[%s] list_init() - cells object alloc failed\n",
             __FILE__
         );
 
@@ -308,9 +408,15 @@ list *list_copy(const list *l){
     }
 
     for (size_t index = 0; index < l->length; ++index){
-        const list_item *i = get_item(l, index, L_TYPE_RESERVED_EMPTY);
+        list_item hold;
+
+        /* copy the payload, appending the view as is would share it between both lists */
+        cell_view(l->cells + index, &hold);
 
-        if (!list_append(copy, i)){
+        hold.data_copy = hold.data;
+        hold.data = NULL;
+
+        if (!list_append(copy, &hold)){
             log_write(
                 logger,
                 LOG_ERROR,
@@ -352,31 +458,42 @@ bool list_resize(list *l, size_t size){
 
     if (size < l->length){
         for (size_t index = size; index < l->length; ++index){
-            item_free(l->items[index]);
+            cell_free(l->cells + index);
         }
 
         l->length = size;
     }
 
-    list_item **items = realloc(l->items, size * sizeof(*items));
+    list_cell *cells = realloc(l->cells, size * sizeof(*cells));
 
-    if (!items){
+    if (!cells){
         log_write(
             logger,
             LOG_ERROR,
-            "[%s] list_resize() - items object realloc failed\n",
+            "[%s] list_resize() - cells object realloc failed\n",
             __FILE__
         );
 
         return false;
     }
 
-    l->items = items;
+    l->cells = cells;
     l->size = size;
 
     return true;
 }
 
+lstatus list_try_get(const list *l, size_t pos, ltype type, list_item *item){
+    const list_cell *c = NULL;
+    lstatus status = try_get_cell(l, pos, type, &c);
+
+    if (item && c){
+        cell_view(c, item);
+    }
+
+    return status;
+}
+
 size_t list_get_length(const list *l){
     if (!l){
         log_write(
@@ -408,13 +525,13 @@ size_t list_get_size(const list *l){
 }
 
 size_t list_get_item_size(const list *l, size_t pos){
-    const list_item *i = get_item(l, pos, L_TYPE_RESERVED_EMPTY);
+    const list_cell *c = get_cell(l, pos, L_TYPE_RESERVED_EMPTY);
 
-    if (!i){
+    if (!c){
         return 0;
     }
 
-    return i->size;
+    return c->size;
 }
 
 bool list_contains(const list *l, size_t size, const void *data){
@@ -430,9 +547,9 @@ bool list_contains(const list *l, size_t size, const void *data){
     }
 
     for (size_t index = 0; index < l->length; ++index){
-        const list_item *i = get_item(l, index, L_TYPE_RESERVED_EMPTY);
+        const list_cell *c = get_cell(l, index, L_TYPE_RESERVED_EMPTY);
 
-        if (size == i->size && memcmp(data, i->data, i->size)){
+        if (size == c->size && memcmp(data, cell_get_data(c), c->size)){
             return true;
         }
     }
@@ -441,116 +558,116 @@ bool list_contains(const list *l, size_t size, const void *data){
 }
 
 ltype list_get_type(const list *l, size_t pos){
-    const list_item *i = get_item(l, pos, L_TYPE_RESERVED_EMPTY);
+    const list_cell *c = get_cell(l, pos, L_TYPE_RESERVED_EMPTY);
 
-    if (!i){
+    if (!c){
         return L_TYPE_RESERVED_ERROR;
     }
 
-    return i->type;
+    return c->type;
 }
 
 bool list_get_bool(const list *l, size_t pos){
-    const list_item *i = get_item(l, pos, L_TYPE_BOOL);
+    const list_cell *c = get_cell(l, pos, L_TYPE_BOOL);
 
-    if (!i){
+    if (!c){
         return false;
     }
 
-    return *(bool *)i->data;
+    return *(bool *)cell_get_data(c);
 }
 
 char list_get_char(const list *l, size_t pos){
-    const list_item *i = get_item(l, pos, L_TYPE_CHAR);
+    const list_cell *c = get_cell(l, pos, L_TYPE_CHAR);
 
-    if (!i){
+    if (!c){
         return 0;
     }
 
-    return *(char *)i->data;
+    return *(char *)cell_get_data(c);
 }
 
 double list_get_double(const list *l, size_t pos){
-    const list_item *i = get_item(l, pos, L_TYPE_DOUBLE);
+    const list_cell *c = get_cell(l, pos, L_TYPE_DOUBLE);
 
-    if (!i){
+    if (!c){
         return 0.0;
     }
 
-    return *(double *)i->data;
+    return *(double *)cell_get_data(c);
 }
 
 int64_t list_get_int(const list *l, size_t pos){
-    const list_item *i = get_item(l, pos, L_TYPE_INT);
+    const list_cell *c = get_cell(l, pos, L_TYPE_INT);
 
-    if (!i){
+    if (!c){
         return 0;
     }
 
-    return *(int64_t *)i->data;
+    return *(int64_t *)cell_get_data(c);
 }
 
 uint64_t list_get_uint(const list *l, size_t pos){
-    const list_item *i = get_item(l, pos, L_TYPE_UINT);
+    const list_cell *c = get_cell(l, pos, L_TYPE_UINT);
 
-    if (!i){
+    if (!c){
         return 0;
     }
 
-    return *(uint64_t *)i->data;
+    return *(uint64_t *)cell_get_data(c);
 }
 
 size_t list_get_size_t(const list *l, size_t pos){
-    const list_item *i = get_item(l, pos, L_TYPE_SIZE_T);
+    const list_cell *c = get_cell(l, pos, L_TYPE_SIZE_T);
 
-    if (!i){
+    if (!c){
         return 0;
     }
 
-    return *(size_t *)i->data;
+    return *(size_t *)cell_get_data(c);
 }
 
 /*
  * READ WARNING FOR THESE FUNCTIONS IN HEADER FILE
  */
 char *list_get_string(const list *l, size_t pos){
-    const list_item *i = get_item(l, pos, L_TYPE_STRING);
+    const list_cell *c = get_cell(l, pos, L_TYPE_STRING);
 
-    if (!i){
+    if (!c){
         return NULL;
     }
 
-    return i->data;
+    return cell_get_data(c);
 }
 
 list *list_get_list(const list *l, size_t pos){
-    const list_item *i = get_item(l, pos, L_TYPE_LIST);
+    const list_cell *c = get_cell(l, pos, L_TYPE_LIST);
 
-    if (!i){
+    if (!c){
         return NULL;
     }
 
-    return i->data;
+    return cell_get_data(c);
 }
 
 map *list_get_map(const list *l, size_t pos){
-    const list_item *i = get_item(l, pos, L_TYPE_MAP);
+    const list_cell *c = get_cell(l, pos, L_TYPE_MAP);
 
-    if (!i){
+    if (!c){
         return NULL;
     }
 
-    return i->data;
+    return cell_get_data(c);
 }
 
 void *list_get_generic(const list *l, size_t pos){
-    const list_item *i = get_item(l, pos, L_TYPE_GENERIC);
+    const list_cell *c = get_cell(l, pos, L_TYPE_GENERIC);
 
-    if (!i){
+    if (!c){
         return NULL;
     }
 
-    return i->data;
+    return cell_get_data(c);
 }
 
 bool list_replace(list *l, size_t pos, const list_item *item){
@@ -586,26 +703,9 @@ bool list_replace(list *l, size_t pos, const list_item *item){
         return false;
     }
 
-    list_item *i = NULL;
+    list_cell hold;
 
-    if (item->data){
-        i = item_init_pointer(
-            item->type,
-            item->size,
-            item->data,
-            item->generic_free
-        );
-    }
-    else {
-        i = item_init(
-            item->type,
-            item->size,
-            item->data_copy,
-            item->generic_free
-        );
-    }
-
-    if (!i){
+    if (!cell_init_item(&hold, item)){
         log_write(
             logger,
             LOG_ERROR,
@@ -616,9 +716,9 @@ bool list_replace(list *l, size_t pos, const list_item *item){
         return false;
     }
 
-    item_free(l->items[pos]);
+    cell_free(l->cells + pos);
 
-    l->items[pos] = i;
+    l->cells[pos] = hold;
 
     return true;
 }
@@ -659,26 +759,9 @@ bool list_insert(list *l, size_t pos, const list_item *item){
         return false;
     }
 
-    list_item *i = NULL;
-
-    if (item->data){
-        i = item_init_pointer(
-            item->type,
-            item->size,
-            item->data,
-            item->generic_free
-        );
-    }
-    else {
-        i = item_init(
-            item->type,
-            item->size,
-            item->data_copy,
-            item->generic_free
-        );
-    }
+    list_cell hold;
 
-    if (!i){
+    if (!cell_init_item(&hold, item)){
         log_write(
             logger,
             LOG_ERROR,
@@ -689,11 +772,9 @@ bool list_insert(list *l, size_t pos, const list_item *item){
         return false;
     }
 
-    for (size_t index = l->length; index > pos; --index){
-        l->items[index] = l->items[index - 1];
-    }
+    memmove(l->cells + pos + 1, l->cells + pos, (l->length - pos) * sizeof(*l->cells));
 
-    l->items[pos] = i;
+    l->cells[pos] = hold;
     l->length += 1;
 
     return true;
@@ -732,26 +813,8 @@ bool list_append(list *l, const list_item *item){
         return false;
     }
 
-    list_item *i = NULL;
-
-    if (item->data){
-        i = item_init_pointer(
-            item->type,
-            item->size,
-            item->data,
-            item->generic_free
-        );
-    }
-    else {
-        i = item_init(
-            item->type,
-            item->size,
-            item->data_copy,
-            item->generic_free
-        );
-    }
-
-    if (!i){
+    /* built in place, nothing moves */
+    if (!cell_init_item(l->cells + l->length, item)){
         log_write(
             logger,
             LOG_ERROR,
@@ -762,29 +825,49 @@ bool list_append(list *l, const list_item *item){
         return false;
     }
 
-    l->items[l->length++] = i;
+    ++l->length;
 
     return true;
 }
 
 void list_pop(list *l, size_t pos, list_item *item){
-    list_item *i = get_item(l, pos, L_TYPE_RESERVED_EMPTY);
+    list_cell *c = get_cell(l, pos, L_TYPE_RESERVED_EMPTY);
 
-    if (!i){
+    if (!c){
         return;
     }
 
     if (item){
-        item->type = i->type;
-        item->size = i->size;
-        item->data = i->data;
-        item->generic_free = i->generic_free;
+        cell_view(c, item);
+
+        if (c->inlined){
+            /* the value goes away with the cell, hand out a copy */
+            item->data = malloc(c->size);
+
+            if (!item->data){
+                log_write(
+                    logger,
+                    LOG_ERROR,
+                    "[%s] list_pop() - item data alloc failed\n",
+                    __FILE__
+                );
+
+                return;
+            }
+
+            memcpy(item->data, &c->value, c->size);
+        }
 
         if (item->data){
-            i->type = L_TYPE_NULL;
-            i->size = 0;
-            i->data = NULL;
-            i->generic_free = NULL;
+            if (c->boxed){
+                free(c->value.data);
+            }
+
+            c->type = L_TYPE_NULL;
+            c->size = 0;
+            c->value.data = NULL;
+            c->inlined = false;
+            c->boxed = false;
         }
     }
     else {
@@ -822,11 +905,9 @@ void list_remove(list *l, size_t pos){
         return;
     }
 
-    item_free(l->items[pos]);
+    cell_free(l->cells + pos);
 
-    for (size_t index = pos; index < l->length; ++index){
-        l->items[index] = l->items[index + 1];
-    }
+    memmove(l->cells + pos, l->cells + pos + 1, (l->length - pos - 1) * sizeof(*l->cells));
 
     --l->length;
 
@@ -886,9 +967,9 @@ void list_free(list *l){
     }
 
     for (size_t index = 0; index < l->length; ++index){
-        item_free(l->items[index]);
+        cell_free(l->cells + index);
     }
 
-    free(l->items);
+    free(l->cells);
     free(l);
 }
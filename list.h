@@ -26,6 +26,13 @@ typedef enum {
     L_TYPE_RESERVED_EMPTY
 } ltype;
 
+typedef enum {
+    L_STATUS_OK,
+    L_STATUS_OUT_OF_RANGE,
+    L_STATUS_TYPE_MISMATCH,
+    L_STATUS_INVALID
+} lstatus;
+
 typedef void (*list_generic_free)(void *);
 
 typedef struct list_item {
@@ -36,8 +43,11 @@ typedef struct list_item {
     list_generic_free generic_free;
 } list_item;
 
+/* private -- items are stored as compact cells and handed out as list_item */
+typedef struct list_cell list_cell;
+
 typedef struct list {
-    list_item **items;
+    list_cell *cells;
     size_t length;
     size_t size;
 } list;
@@ -46,6 +56,15 @@ list *list_init(void);
 list *list_copy(const list *);
 bool list_resize(list *, size_t);
 
+/*
+ * silent lookup -- nothing is logged. the item is written to the out
+ * pointer on L_STATUS_OK and on L_STATUS_TYPE_MISMATCH
+ * (L_TYPE_RESERVED_EMPTY matches any type). the out pointer may be NULL.
+ * its data points into the list and is valid until the list is next
+ * modified
+ */
+lstatus list_try_get(const list *, size_t, ltype, list_item *);
+
 size_t list_get_length(const list *);
 size_t list_get_size(const list *);
 size_t list_get_item_size(const list *, size_t);
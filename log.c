@@ -86,6 +86,7 @@ bool log_write(const logctx *log, logtype type, const char *format, ...){
 
         break;
     case LOG_RAW:
+    default:
         /* keep typestr NULL */
 
         break;
@@ -1,115 +1,471 @@
 #include "map.h"
+#include "map_item.h"
 
+#include "atom.h"
+#include "filter.h"
 #include "log.h"
 #include "str.h"
 
+#include "hashers/murmur3.h"
 #include "hashers/spooky.h"
+#include "hashers/wyhash.h"
 
+#include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 #define MAP_MINIMUM_SIZE 8
 #define MAP_GROWTH_LOAD_FACTOR 0.8
 
-#define LCG_MULTIPLIER 6364136223846793005
-#define LCG_INCREMENT 1
+/* old table slots migrated per mutation during an incremental resize */
+#define MAP_REHASH_STEP 64
+
+/* a full nodes array is compacted instead of grown once 1/4 of it is holes */
+#define MAP_COMPACT_DIVISOR 4
+
+/* nodes an incremental compaction looks at per mutation */
+#define MAP_COMPACT_STEP 16
+
+/* keys hashed and prefetched together by map_get_many */
+#define MAP_BATCH_SIZE 16
+
+/* arena blocks start small and double up to the maximum */
+#define MAP_ARENA_MINIMUM_BLOCK 4096
+#define MAP_ARENA_MAXIMUM_BLOCK (1 << 20)
+
+/*
+ * control bytes -- one per slot. a full slot stores the low
+ * 7 bits of its hash (H2), everything else has the high bit
+ * set. slots are probed a group (16 control bytes) at a time
+ *
+ * in robin hood mode a full slot stores its distance from its
+ * home slot instead and slots are probed one at a time
+ */
+#define MAP_GROUP_WIDTH 16
+#define MAP_ROBIN_HOOD_MAX_DISTANCE 126
+
+#define CTRL_EMPTY ((int8_t)-128)
+#define CTRL_DELETED ((int8_t)-2)
+#define CTRL_SENTINEL ((int8_t)-1)
 
 static logctx *logger = NULL;
 
+/* removed nodes are left as holes (key type M_TYPE_RESERVED_EMPTY) until compacted */
 typedef struct node {
-    uint32_t hash;
-
-    map_item *key;
-    map_item *value;
+    uint64_t hash;
 
-    node *prev;
-    node *next;
+    map_item key;
+    map_item value;
 } node;
 
+/* blocks are chained newest first, m->arena is the one being filled */
+typedef struct map_arena {
+    struct map_arena *next;
+    size_t size;
+    size_t used;
+    max_align_t data[];
+} map_arena;
+
 static bool is_power_of_two(size_t number){
     return number && !(number & (number - 1));
 }
 
-static uint32_t generate_hash(uint32_t seed, size_t size, const void *data){
-    return spooky_hash32(data, size, seed);
+static uint64_t generate_hash(const map *m, size_t size, const void *data){
+    return m->hasher(data, size, m->seed);
 }
 
-static size_t generate_index(uint32_t seed, size_t size){
-    size_t multiplier = LCG_MULTIPLIER;
-    size_t increment = LCG_INCREMENT;
+/* the filter's second hash is derived from the stored one so keys are never rehashed */
+static uint64_t filter_bits(uint64_t hash){
+    hash ^= hash >> 33;
+    hash *= 0xFF51AFD7ED558CCDULL;
+    hash ^= hash >> 33;
 
-    return (multiplier * seed + increment) & (size - 1);
+    return hash;
 }
 
-static bool check_availability(map *m){
-    double load = (double)m->length / (double)m->size;
+static size_t hash_group(uint64_t hash){
+    return hash >> 7;
+}
 
-    if (load >= MAP_GROWTH_LOAD_FACTOR){
-        size_t newsize = m->size << 1;
+static int8_t hash_fragment(uint64_t hash){
+    return hash & 0x7F;
+}
+
+static size_t group_count(size_t size){
+    return size < MAP_GROUP_WIDTH ? 1 : size / MAP_GROUP_WIDTH;
+}
+
+#ifdef __SSE2__
+static uint32_t group_match(const int8_t *ctrl, int8_t fragment){
+    __m128i group = _mm_loadu_si128((const __m128i *)ctrl);
+
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(fragment), group));
+}
+
+static uint32_t group_match_empty_or_deleted(const int8_t *ctrl){
+    __m128i group = _mm_loadu_si128((const __m128i *)ctrl);
+
+    return _mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(CTRL_SENTINEL), group));
+}
+#else
+static uint32_t group_match(const int8_t *ctrl, int8_t fragment){
+    uint32_t mask = 0;
+
+    for (size_t index = 0; index < MAP_GROUP_WIDTH; ++index){
+        if (ctrl[index] == fragment){
+            mask |= 1U << index;
+        }
+    }
+
+    return mask;
+}
+
+static uint32_t group_match_empty_or_deleted(const int8_t *ctrl){
+    uint32_t mask = 0;
+
+    for (size_t index = 0; index < MAP_GROUP_WIDTH; ++index){
+        if (ctrl[index] < CTRL_SENTINEL){
+            mask |= 1U << index;
+        }
+    }
+
+    return mask;
+}
+#endif
+
+static uint32_t group_match_empty(const int8_t *ctrl){
+    return group_match(ctrl, CTRL_EMPTY);
+}
+
+static bool table_init(map_table *t, size_t size){
+    size_t ctrlsize = group_count(size) * MAP_GROUP_WIDTH;
+
+    t->ctrl = malloc(ctrlsize);
+
+    if (!t->ctrl){
+        return false;
+    }
+
+    t->slots = malloc(size * sizeof(*t->slots));
+
+    if (!t->slots){
+        free(t->ctrl);
+
+        t->ctrl = NULL;
+
+        return false;
+    }
+
+    memset(t->ctrl, CTRL_EMPTY, size);
+
+    /* tables smaller than a group pad the group with sentinels */
+    memset(t->ctrl + size, CTRL_SENTINEL, ctrlsize - size);
+
+    t->size = size;
+    t->deleted = 0;
+
+    return true;
+}
+
+static void table_free(map_table *t){
+    free(t->ctrl);
+    free(t->slots);
+
+    t->ctrl = NULL;
+    t->slots = NULL;
+    t->size = 0;
+    t->deleted = 0;
+}
+
+static void *item_get_data(const map_item *i){
+    return i->inlined ? (void *)&i->local : i->data;
+}
+
+static bool node_is_hole(const node *n){
+    return n->key.type == M_TYPE_RESERVED_EMPTY;
+}
+
+static bool node_matches(const node *n, uint64_t hash, size_t size, const void *key){
+    if (hash != n->hash || size != n->key.size){
+        return false;
+    }
+
+    /* interned and borrowed keys usually match by pointer */
+    const void *data = item_get_data(&n->key);
 
-        if (newsize <= m->size){
+    return key == data || !memcmp(key, data, size);
+}
+
+static size_t find_free_index(const map_table *t, uint64_t hash){
+    size_t mask = group_count(t->size) - 1;
+    size_t group = hash_group(hash) & mask;
+
+    for (size_t probe = 0; ; ++probe){
+        uint32_t matches = group_match_empty_or_deleted(t->ctrl + group * MAP_GROUP_WIDTH);
+
+        if (matches){
+            return group * MAP_GROUP_WIDTH + __builtin_ctz(matches);
+        }
+
+        group = (group + probe + 1) & mask;
+    }
+}
+
+static size_t find_slot_group(const map *m, const map_table *t, uint64_t hash, size_t size, const void *key){
+    size_t mask = group_count(t->size) - 1;
+    size_t group = hash_group(hash) & mask;
+    int8_t fragment = hash_fragment(hash);
+
+    for (size_t probe = 0; probe <= mask; ++probe){
+        const int8_t *ctrl = t->ctrl + group * MAP_GROUP_WIDTH;
+        uint32_t matches = group_match(ctrl, fragment);
+
+        while (matches){
+            size_t index = group * MAP_GROUP_WIDTH + __builtin_ctz(matches);
+
+            if (node_matches(m->nodes + t->slots[index], hash, size, key)){
+                return index;
+            }
+
+            matches &= matches - 1;
+        }
+
+        if (group_match_empty(ctrl)){
+            break;
+        }
+
+        group = (group + probe + 1) & mask;
+    }
+
+    return SIZE_MAX;
+}
+
+static size_t find_slot_robin_hood(const map *m, const map_table *t, uint64_t hash, size_t size, const void *key){
+    size_t mask = t->size - 1;
+    size_t index = hash & mask;
+
+    /* a slot closer to its home than we are to ours ends the probe */
+    for (int8_t distance = 0; t->ctrl[index] >= distance; ++distance){
+        if (t->ctrl[index] == distance && node_matches(m->nodes + t->slots[index], hash, size, key)){
+            return index;
+        }
+
+        index = (index + 1) & mask;
+    }
+
+    return SIZE_MAX;
+}
+
+/* returns the slot in t holding key or SIZE_MAX */
+static size_t find_slot(const map *m, const map_table *t, uint64_t hash, size_t size, const void *key){
+    if (m->probe == M_PROBE_ROBIN_HOOD){
+        return find_slot_robin_hood(m, t, hash, size, key);
+    }
+
+    return find_slot_group(m, t, hash, size, key);
+}
+
+static node *find_node(const map *m, uint64_t hash, size_t size, const void *key){
+    if (m->filter && !filter_contains_hash(m->filter, hash, filter_bits(hash))){
+        return NULL;
+    }
+
+    size_t index = find_slot(m, &m->table, hash, size, key);
+
+    if (index != SIZE_MAX){
+        return m->nodes + m->table.slots[index];
+    }
+
+    if (m->rehash.ctrl){
+        index = find_slot(m, &m->rehash, hash, size, key);
+
+        if (index != SIZE_MAX){
+            return m->nodes + m->rehash.slots[index];
+        }
+    }
+
+    return NULL;
+}
+
+static void *arena_alloc(map *m, size_t size){
+    size = (size + _Alignof(max_align_t) - 1) & ~(_Alignof(max_align_t) - 1);
+
+    map_arena *a = m->arena;
+
+    if (a->size - a->used < size){
+        size_t blocksize = a->size < MAP_ARENA_MAXIMUM_BLOCK ? a->size << 1 : a->size;
+
+        if (blocksize < size){
+            blocksize = size;
+        }
+
+        a = malloc(sizeof(*a) + blocksize);
+
+        if (!a){
             log_write(
                 logger,
-                LOG_WARNING,
-                "[%s] map_set() - newsize (%ld) <= m->size (%ld) -- unable to grow map\n",
-                __FILE__,
-                newsize,
-                m->size
+                LOG_ERROR,
+                "[%s] arena_alloc() - block alloc failed\n",
+                __FILE__
             );
 
-            return false;
+            return NULL;
         }
 
-        if (!map_resize(m, newsize)){
-            return false;
-        }
+        a->next = m->arena;
+        a->size = blocksize;
+        a->used = 0;
+
+        m->arena = a;
     }
 
-    return true;
+    void *data = (unsigned char *)a->data + a->used;
+
+    a->used += size;
+
+    return data;
 }
 
-static map_item *item_init_pointer(mtype type, size_t size, void *data, map_generic_free generic_free){
-    map_item *i = malloc(sizeof(*i));
+static void arena_free(map_arena *a){
+    while (a){
+        map_arena *next = a->next;
 
-    if (!i){
+        free(a);
+
+        a = next;
+    }
+}
+
+/*
+ * one block for size bytes of key copies. arena maps take it from the
+ * arena, others chain it on m->blocks
+ */
+static void *block_alloc(map *m, size_t size){
+    if (m->arena){
+        return arena_alloc(m, size);
+    }
+
+    map_arena *b = malloc(sizeof(*b) + size);
+
+    if (!b){
         log_write(
             logger,
             LOG_ERROR,
-            "[%s] item_init_pointer() - item alloc failed\n",
+            "[%s] block_alloc() - block alloc failed\n",
             __FILE__
         );
 
         return NULL;
     }
 
+    b->next = m->blocks;
+    b->size = size;
+    b->used = size;
+
+    m->blocks = b;
+
+    return b->data;
+}
+
+/*
+ * payloads the item does not own (arena copies and borrowed keys) are
+ * marked by data_copy pointing at them -- every other stored item
+ * keeps data_copy NULL. inline payloads aren't owned either
+ */
+static void *item_alloc(map *m, map_item *i, size_t size){
+    if (!m || !m->arena){
+        return malloc(size);
+    }
+
+    void *data = arena_alloc(m, size);
+
+    i->data_copy = data;
+
+    return data;
+}
+
+static bool item_is_borrowed(const map_item *i){
+    return i->inlined || (i->data_copy && i->data_copy == i->data);
+}
+
+static bool item_is_inlinable(mtype type, size_t size){
+    switch (type){
+    case M_TYPE_BOOL:
+    case M_TYPE_CHAR:
+    case M_TYPE_DOUBLE:
+    case M_TYPE_INT:
+    case M_TYPE_UINT:
+    case M_TYPE_SIZE_T:
+        return size <= sizeof(map_inline);
+    default:
+        return false;
+    }
+}
+
+/* copy of a stored item for the caller -- an inline payload is pointed at where it is stored */
+static void item_view(map_item *out, const map_item *i){
+    *out = *i;
+
+    if (i->inlined){
+        out->inlined = false;
+        out->data = (void *)&i->local;
+    }
+}
+
+static bool item_init_pointer(map_item *i, mtype type, size_t size, void *data, map_generic_free generic_free){
     i->type = type;
+    i->inlined = false;
     i->size = size;
     i->data = data;
+    i->data_copy = NULL;
     i->generic_free = generic_free;
 
-    return i;
+    return true;
 }
 
-static map_item *item_init(mtype type, size_t size, const void *data, map_generic_free generic_free){
-    map_item *i = malloc(sizeof(*i));
+/* inline keys never are, they were copied */
+static bool key_is_atom(const map_item *key){
+    if (!key->data){
+        return false;
+    }
 
-    if (!i){
-        log_write(
-            logger,
-            LOG_ERROR,
-            "[%s] item_init() - item alloc failed\n",
-            __FILE__
-        );
+    const atom *a = atom_find(key->size, key->data);
 
-        return NULL;
-    }
+    return a && a->string == key->data;
+}
+
+static bool item_init_borrowed(map_item *i, mtype type, size_t size, const void *data){
+    i->type = type;
+    i->inlined = false;
+    i->size = size;
+    i->data = (void *)data;
+    i->data_copy = data;
+    i->generic_free = NULL;
+
+    return true;
+}
 
+static bool item_init(map *m, map_item *i, mtype type, size_t size, const void *data, map_generic_free generic_free){
     i->type = type;
+    i->inlined = false;
     i->size = size;
+    i->data_copy = NULL;
     i->generic_free = generic_free;
 
-    if (type == M_TYPE_STRING){
-        i->data = malloc(size + 1);
+    /* items kept outside a map (m is NULL) are read through data, so they stay out of line */
+    if (m && item_is_inlinable(type, size)){
+        i->inlined = true;
+        i->data = NULL;
+        i->local.u = 0;
+
+        memcpy(&i->local, data, size);
+    }
+    else if (type == M_TYPE_STRING){
+        i->data = item_alloc(m, i, size + 1);
 
         if (!i->data){
             log_write(
@@ -119,12 +475,12 @@ static map_item *item_init(mtype type, size_t size, const void *data, map_generi
                 __FILE__
             );
 
-            free(i);
-
-            return NULL;
+            return false;
         }
 
-        string_copy(data, i->data, size);
+        memcpy(i->data, data, size);
+
+        ((char *)i->data)[size] = '\0';
     }
     else if (type == M_TYPE_LIST){
         i->data = list_copy(data);
@@ -137,9 +493,7 @@ static map_item *item_init(mtype type, size_t size, const void *data, map_generi
                 __FILE__
             );
 
-            free(i);
-
-            return NULL;
+            return false;
         }
     }
     else if (type == M_TYPE_MAP){
@@ -153,16 +507,14 @@ static map_item *item_init(mtype type, size_t size, const void *data, map_generi
                 __FILE__
             );
 
-            free(i);
-
-            return NULL;
+            return false;
         }
     }
     else if (type == M_TYPE_NULL){
         i->data = NULL;
     }
     else {
-        i->data = malloc(size);
+        i->data = item_alloc(m, i, size);
 
         if (!i->data){
             log_write(
@@ -172,26 +524,38 @@ static map_item *item_init(mtype type, size_t size, const void *data, map_generi
                 __FILE__
             );
 
-            free(i);
-
-            return NULL;
+            return false;
         }
 
         memcpy(i->data, data, size);
     }
 
-    return i;
+    return true;
 }
 
-static void item_free(map_item *i){
-    if (!i){
-        log_write(
-            logger,
-            LOG_ERROR,
-            "[%s] item_free() - item should *not* be NULL\n",
-            __FILE__
+static bool item_init_value(map *m, map_item *i, const map_item *value){
+    if (value->data){
+        return item_init_pointer(
+            i,
+            value->type,
+            value->size,
+            value->data,
+            value->generic_free
         );
+    }
+
+    return item_init(
+        m,
+        i,
+        value->type,
+        value->size,
+        value->data_copy,
+        value->generic_free
+    );
+}
 
+static void item_free(map_item *i){
+    if (item_is_borrowed(i)){
         return;
     }
 
@@ -218,918 +582,2436 @@ static void item_free(map_item *i){
     default:
         free(i->data);
     }
-
-    free(i);
 }
 
-static node *node_init(const map_item *key, const map_item *value){
-    node *n = calloc(1, sizeof(*n));
-
-    if (!n){
-        log_write(
-            logger,
-            LOG_ERROR,
-            "[%s] node_init() - node alloc failed\n",
-            __FILE__
-        );
+static size_t insert_slot_group(map_table *t, uint64_t hash){
+    size_t index = find_free_index(t, hash);
 
-        return NULL;
+    if (t->ctrl[index] == CTRL_DELETED){
+        --t->deleted;
     }
 
-    n->key = item_init(key->type, key->size, key->data_copy, key->generic_free);
+    t->ctrl[index] = hash_fragment(hash);
 
-    if (!n->key){
-        log_write(
-            logger,
-            LOG_ERROR,
-            "[%s] node_init() - key initialization failed\n",
-            __FILE__
-        );
+    return index;
+}
 
-        free(n);
+static size_t insert_slot_robin_hood(map_table *t, uint64_t hash){
+    size_t mask = t->size - 1;
+    size_t index = hash & mask;
+    int8_t distance = 0;
 
-        return NULL;
-    }
+    while (t->ctrl[index] >= distance){
+        if (++distance > MAP_ROBIN_HOOD_MAX_DISTANCE){
+            return SIZE_MAX;
+        }
 
-    if (value->data){
-        n->value = item_init_pointer(
-            value->type,
-            value->size,
-            value->data,
-            value->generic_free
-        );
+        index = (index + 1) & mask;
     }
-    else {
-        n->value = item_init(
-            value->type,
-            value->size,
-            value->data_copy,
-            value->generic_free
-        );
+
+    /* everything from here to the next empty slot moves up by one */
+    size_t end = index;
+
+    while (t->ctrl[end] != CTRL_EMPTY){
+        if (t->ctrl[end] >= MAP_ROBIN_HOOD_MAX_DISTANCE){
+            return SIZE_MAX;
+        }
+
+        end = (end + 1) & mask;
     }
 
-    if (!n->value){
-        log_write(
-            logger,
-            LOG_ERROR,
-            "[%s] node_init() - value initialization failed\n",
-            __FILE__
-        );
+    while (end != index){
+        size_t from = (end - 1) & mask;
 
-        item_free(n->key);
-        free(n);
+        t->slots[end] = t->slots[from];
+        t->ctrl[end] = t->ctrl[from] + 1;
 
-        return NULL;
+        end = from;
     }
 
-    return n;
+    t->ctrl[index] = distance;
+
+    return index;
 }
 
-static void node_free(node *n){
-    if (!n){
-        log_write(
-            logger,
-            LOG_ERROR,
-            "[%s] node_free() - node should *not* be NULL\n",
-            __FILE__
-        );
+/*
+ * claims a slot for hash and returns its index -- the caller fills in
+ * the entry. returns SIZE_MAX when robin hood probing would exceed its
+ * maximum distance -- the table has to grow before trying again
+ */
+static size_t insert_slot(const map *m, map_table *t, uint64_t hash){
+    if (m->probe == M_PROBE_ROBIN_HOOD){
+        return insert_slot_robin_hood(t, hash);
+    }
 
-        return;
+    return insert_slot_group(t, hash);
+}
+
+static void erase_slot_group(map_table *t, size_t index){
+    const int8_t *ctrl = t->ctrl + index / MAP_GROUP_WIDTH * MAP_GROUP_WIDTH;
+
+    /*
+     * a probe only walks past a group that has no empty slots,
+     * so if this group still has one the slot can be reused
+     */
+    if (group_match_empty(ctrl)){
+        t->ctrl[index] = CTRL_EMPTY;
+    }
+    else {
+        t->ctrl[index] = CTRL_DELETED;
+
+        ++t->deleted;
+    }
+}
+
+static void erase_slot_robin_hood(map_table *t, size_t index){
+    size_t mask = t->size - 1;
+    size_t next = (index + 1) & mask;
+
+    /* shift the rest of the run back instead of leaving a tombstone */
+    while (t->ctrl[next] > 0){
+        t->slots[index] = t->slots[next];
+        t->ctrl[index] = t->ctrl[next] - 1;
+
+        index = next;
+        next = (next + 1) & mask;
     }
 
-    item_free(n->key);
-    item_free(n->value);
+    t->ctrl[index] = CTRL_EMPTY;
+}
 
-    free(n);
+static void erase_slot(const map *m, map_table *t, size_t index){
+    if (m->probe == M_PROBE_ROBIN_HOOD){
+        erase_slot_robin_hood(t, index);
+    }
+    else {
+        erase_slot_group(t, index);
+    }
 }
 
-static bool get_node_index(const map *m, size_t *ret, size_t size, const void *key){
-    if (!m){
+/*
+ * indexes the live nodes into t by the position they will have once
+ * the holes are squeezed out. false if robin hood hit its probe limit
+ */
+static bool table_build(const map *m, map_table *t){
+    uint32_t position = 0;
+
+    for (size_t index = 0; index < m->nodeslength; ++index){
+        const node *n = m->nodes + index;
+
+        if (node_is_hole(n)){
+            continue;
+        }
+
+        size_t slot = insert_slot(m, t, n->hash);
+
+        if (slot == SIZE_MAX){
+            return false;
+        }
+
+        t->slots[slot] = position++;
+    }
+
+    return true;
+}
+
+static void nodes_compact(map *m){
+    size_t position = 0;
+
+    for (size_t index = 0; index < m->nodeslength; ++index){
+        if (node_is_hole(m->nodes + index)){
+            continue;
+        }
+
+        if (index != position){
+            m->nodes[position] = m->nodes[index];
+        }
+
+        ++position;
+    }
+
+    m->nodeslength = position;
+    m->compacting = false;
+}
+
+static bool nodes_resize(map *m, size_t size){
+    if (size > (size_t)UINT32_MAX + 1){
         log_write(
             logger,
             LOG_WARNING,
-            "[%s] get_node_index() - map is NULL\n",
-            __FILE__
+            "[%s] nodes_resize() - size (%ld) exceeds the 32-bit slot index\n",
+            __FILE__,
+            size
         );
 
         return false;
     }
-    else if (!key){
+
+    node *nodes = realloc(m->nodes, size * sizeof(*nodes));
+
+    if (!nodes){
         log_write(
             logger,
-            LOG_WARNING,
-            "[%s] get_node_index() - key is NULL\n",
+            LOG_ERROR,
+            "[%s] nodes_resize() - nodes realloc failed\n",
             __FILE__
         );
 
         return false;
     }
 
-    uint32_t hash = generate_hash(m->seed, size, key);
-    size_t index = generate_index(hash, m->size);
-    node *n = m->nodes[index];
+    m->nodes = nodes;
+    m->nodessize = size;
 
-    bool found = false;
+    return true;
+}
 
-    for (size_t count = 0; count < m->size; ++count){
-        if (n && hash == n->hash && !memcmp(key, n->key->data, n->key->size)){
-            found = true;
+/* trailing holes are dropped right away so the last node is always live */
+static void nodes_trim(map *m){
+    while (m->nodeslength && node_is_hole(m->nodes + m->nodeslength - 1)){
+        --m->nodeslength;
+    }
+}
 
-            break;
-        }
+static void node_remove(map *m, node *n){
+    size_t index = find_slot(m, &m->table, n->hash, n->key.size, item_get_data(&n->key));
 
-        index = generate_index(index, m->size);
-        n = m->nodes[index];
+    if (index != SIZE_MAX){
+        erase_slot(m, &m->table, index);
+    }
+    else {
+        erase_slot(m, &m->rehash, find_slot(m, &m->rehash, n->hash, n->key.size, item_get_data(&n->key)));
     }
 
-    if (!found){
-        log_write(
-            logger,
-            LOG_DEBUG,
-            "[%s] get_node_index() - key does not exist\n",
-            __FILE__
-        );
+    item_free(&n->key);
+    item_free(&n->value);
 
-        return false;
-    }
+    n->key.type = M_TYPE_RESERVED_EMPTY;
 
-    *ret = index;
+    --m->length;
 
-    return true;
+    nodes_trim(m);
 }
 
-static node *get_node(const map *m, size_t size, const void *key, mtype type){
-    if (!m){
-        log_write(
-            logger,
-            LOG_WARNING,
-            "[%s] get_node() - map is NULL\n",
-            __FILE__
-        );
+/* moves a live node down into a hole and points its slot at the new position */
+static void node_relocate(map *m, size_t from, size_t to){
+    node *n = m->nodes + from;
+    const void *key = item_get_data(&n->key);
+    map_table *t = &m->table;
+    size_t index = find_slot(m, t, n->hash, n->key.size, key);
 
-        return NULL;
+    if (index == SIZE_MAX){
+        t = &m->rehash;
+        index = find_slot(m, t, n->hash, n->key.size, key);
     }
-    else if (!key){
-        log_write(
-            logger,
-            LOG_WARNING,
-            "[%s] get_node() - key is NULL\n",
-            __FILE__
-        );
 
-        return NULL;
-    }
+    t->slots[index] = (uint32_t)to;
+    m->nodes[to] = *n;
 
-    size_t index;
+    n->key.type = M_TYPE_RESERVED_EMPTY;
+}
 
-    if (!get_node_index(m, &index, size, key)){
-        return NULL;
+/*
+ * looks at up to count more nodes of an incremental compaction. live
+ * nodes keep their order, so iteration order is unchanged
+ */
+static void compact_step(map *m, size_t count){
+    while (m->compacting && count--){
+        if (m->compactread >= m->nodeslength){
+            /* everything from compactwrite on is holes by now */
+            if (m->compactwrite < m->nodeslength){
+                m->nodeslength = m->compactwrite;
+            }
+
+            nodes_trim(m);
+
+            m->compacting = false;
+
+            return;
+        }
+
+        if (!node_is_hole(m->nodes + m->compactread)){
+            if (m->compactread != m->compactwrite){
+                node_relocate(m, m->compactread, m->compactwrite);
+            }
+
+            ++m->compactwrite;
+        }
+
+        ++m->compactread;
     }
+}
+
+/*
+ * moves up to count slots of the old table into the new one. returns
+ * false if a robin hood insert hit its probe limit -- the caller has to
+ * fall back to a synchronous map_resize which rebuilds from the nodes
+ */
+static bool rehash_step(map *m, size_t count){
+    map_table *old = &m->rehash;
 
-    node *n = m->nodes[index];
+    while (old->ctrl && count--){
+        if (old->ctrl[m->rehashindex] >= 0){
+            uint32_t position = old->slots[m->rehashindex];
+            size_t index = insert_slot(m, &m->table, m->nodes[position].hash);
 
-    if (type != M_TYPE_RESERVED_EMPTY && n->value->type != type){
-        log_write(
-            logger,
-            LOG_WARNING,
-            "[%s] get_node() - node type does *not* match\n",
-            __FILE__
-        );
+            if (index == SIZE_MAX){
+                return false;
+            }
+
+            m->table.slots[index] = position;
+
+            /* robin hood erase can pull the next slot into this one */
+            erase_slot(m, old, m->rehashindex);
+
+            if (old->ctrl[m->rehashindex] >= 0){
+                continue;
+            }
+        }
+
+        if (++m->rehashindex >= old->size){
+            table_free(old);
+
+            m->rehashindex = 0;
+        }
     }
 
-    return n;
+    return true;
 }
 
-map *map_init(void){
-    if (MAP_MINIMUM_SIZE <= 0){
+static bool rehash_start(map *m, size_t size){
+    map_table table;
+
+    if (!table_init(&table, size)){
         log_write(
             logger,
             LOG_ERROR,
-            "[%s] map_init() - MAP_MINIMUM_SIZE must be greater than 0\n",
+            "[%s] rehash_start() - table alloc failed\n",
             __FILE__
         );
 
-        return NULL;
+        return false;
     }
-    else if (!is_power_of_two(MAP_MINIMUM_SIZE)){
-        log_write(
-            logger,
-            LOG_ERROR,
-            "[%s] map_init() - MAP_MINIMUM_SIZE must be a power of 2\n",
-            __FILE__
-        );
 
-        return NULL;
+    m->rehash = m->table;
+    m->table = table;
+    m->rehashindex = 0;
+
+    ++m->resizes;
+
+    return true;
+}
+
+/* the share of an incremental resize or compaction each mutation pays */
+static void incremental_advance(map *m){
+    if (m->rehash.ctrl && !rehash_step(m, MAP_REHASH_STEP)){
+        if (!map_resize(m, m->table.size << 1)){
+            log_write(
+                logger,
+                LOG_ERROR,
+                "[%s] incremental_advance() - map_resize call failed\n",
+                __FILE__
+            );
+        }
     }
 
+    compact_step(m, MAP_COMPACT_STEP);
+}
 
-    map *m = calloc(1, sizeof(*m));
+static bool check_availability(map *m){
+    double load = (double)(m->length + m->table.deleted) / (double)m->table.size;
 
-    if (!m){
-        log_write(
-            logger,
-            LOG_ERROR,
-            "[%s] map_init() - map alloc failed\n",
-            __FILE__
-        );
+    if (load >= MAP_GROWTH_LOAD_FACTOR){
+        /* mostly tombstones -- rebuild in place instead of growing */
+        double live = (double)m->length / (double)m->table.size;
+        size_t newsize = live >= MAP_GROWTH_LOAD_FACTOR / 2 ? m->table.size << 1 : m->table.size;
 
-        return NULL;
+        if (newsize < m->table.size){
+            log_write(
+                logger,
+                LOG_WARNING,
+                "[%s] map_set() - newsize (%ld) < m->table.size (%ld) -- unable to grow map\n",
+                __FILE__,
+                newsize,
+                m->table.size
+            );
+
+            return false;
+        }
+
+        /* same size included, a tombstone rebuild is spread out too. an unfinished one can't be stacked on */
+        if (m->resize == M_RESIZE_INCREMENTAL && !m->rehash.ctrl){
+            if (!rehash_start(m, newsize)){
+                return false;
+            }
+        }
+        else if (!map_resize(m, newsize)){
+            return false;
+        }
     }
 
-    m->length = 0;
-    m->size = MAP_MINIMUM_SIZE;
-    m->nodes = calloc(m->size, sizeof(*m->nodes));
+    bool holey = m->nodeslength - m->length >= m->nodessize / MAP_COMPACT_DIVISOR;
 
-    if (!m->nodes){
+    /* incremental maps start squeezing out holes before the array is full */
+    if (m->resize == M_RESIZE_INCREMENTAL && holey && !m->compacting){
+        m->compacting = true;
+        m->compactread = 0;
+        m->compactwrite = 0;
+    }
+
+    if (m->nodeslength == m->nodessize){
+        /* enough holes -- squeeze them out instead of growing */
+        if (m->resize != M_RESIZE_INCREMENTAL && holey){
+            return map_resize(m, m->table.size);
+        }
+
+        /* or a compaction that hasn't caught up yet -- grow rather than stall */
+        return nodes_resize(m, m->nodessize << 1);
+    }
+
+    return true;
+}
+
+/* replaces the filter with an empty one of capacity and adds the live nodes */
+static void filter_rebuild(map *m, size_t capacity){
+    filter *f = filter_init(capacity, m->filter->rate);
+
+    if (!f){
         log_write(
             logger,
             LOG_ERROR,
-            "[%s] map_init() - nodes alloc failed\n",
+            "[%s] filter_rebuild() - filter_init call failed -- dropping the filter\n",
             __FILE__
         );
 
-        free(m);
+        filter_free(m->filter);
 
-        return NULL;
+        m->filter = NULL;
+
+        return;
     }
 
-    m->seed = (uint32_t)&m;
+    for (size_t index = 0; index < m->nodeslength; ++index){
+        const node *n = m->nodes + index;
+
+        if (!node_is_hole(n)){
+            filter_add_hash(f, n->hash, filter_bits(n->hash));
+        }
+    }
 
-    m->first = NULL;
-    m->last = NULL;
+    filter_free(m->filter);
 
-    return m;
+    m->filter = f;
 }
 
-map *map_copy(const map *m){
-    if (!m){
+/* room for length entries without a resize -- tombstones are dropped if they'd get in the way */
+static bool reserve(map *m, size_t length){
+    size_t size = m->table.size;
+
+    while ((double)length / (double)size >= MAP_GROWTH_LOAD_FACTOR){
+        size <<= 1;
+    }
+
+    bool crowded = (double)(length + m->table.deleted) / (double)m->table.size >= MAP_GROWTH_LOAD_FACTOR;
+
+    if ((size != m->table.size || crowded || m->rehash.ctrl) && !map_resize(m, size)){
         log_write(
             logger,
-            LOG_WARNING,
-            "[%s] map_copy() - map is NULL\n",
+            LOG_ERROR,
+            "[%s] reserve() - map_resize call failed\n",
             __FILE__
         );
 
-        return NULL;
+        return false;
     }
 
-    map *copy = map_init();
+    size_t nodes = m->nodeslength + (length > m->length ? length - m->length : 0);
 
-    if (!copy){
+    if (nodes > m->nodessize && !nodes_resize(m, nodes)){
         log_write(
             logger,
             LOG_ERROR,
-            "[%s] map_copy() - map intiialization failed\n",
+            "[%s] reserve() - nodes_resize call failed\n",
             __FILE__
         );
 
-        return NULL;
+        return false;
     }
 
-    node *n = m->first;
+    if (m->filter && filter_get_capacity(m->filter) < length){
+        filter_rebuild(m, length);
+    }
 
-    while (n){
-        const map_item *k = n->key;
-        const map_item *v = n->value;
+    return true;
+}
 
-        if (!map_set(copy, k, v)){
-            log_write(
-                logger,
-                LOG_ERROR,
-                "[%s] map_copy() - map_set call failed\n",
-                __FILE__
-            );
+/* never logs -- misses are expected on this path */
+/* relaxed atomics so maps read from several threads (cmap) still count */
+static void count_lookup(const map *m, bool hit){
+#ifdef MAP_STATS_COUNTERS
+    map *counted = (map *)m;
+
+    __atomic_fetch_add(hit ? &counted->hits : &counted->misses, 1, __ATOMIC_RELAXED);
+#else
+    (void)m;
+    (void)hit;
+#endif
+}
 
-            map_free(copy);
+static mstatus try_get_node(const map *m, map_hash hash, size_t size, const void *key, mtype type, node **out){
+    if (!m || !key || !out){
+        return M_STATUS_INVALID;
+    }
 
-            return NULL;
-        }
+    node *n = find_node(m, hash, size, key);
+
+    count_lookup(m, n != NULL);
 
-        n = n->next;
+    *out = n;
+
+    if (!n){
+        return M_STATUS_NOT_FOUND;
+    }
+    else if (type != M_TYPE_RESERVED_EMPTY && n->value.type != type){
+        return M_STATUS_TYPE_MISMATCH;
     }
 
-    return copy;
+    return M_STATUS_OK;
 }
 
-bool map_resize(map *m, size_t size){
-    if (!m){
+static node *get_node_hashed(const map *m, map_hash hash, size_t size, const void *key, mtype type){
+    node *n = NULL;
+    mstatus status = try_get_node(m, hash, size, key, type, &n);
+
+    if (status == M_STATUS_INVALID){
         log_write(
             logger,
             LOG_WARNING,
-            "[%s] map_resize() - map is NULL\n",
+            "[%s] get_node_hashed() - map or key is NULL\n",
             __FILE__
         );
-
-        return false;
     }
-    else if (size == 0 || size < MAP_MINIMUM_SIZE){
+    else if (status == M_STATUS_NOT_FOUND){
         log_write(
             logger,
-            LOG_WARNING,
-            "[%s] map_resize() - size cannot be 0 or less than MAP_MINIMUM_SIZE -- set to MAP_MINIMUM_SIZE (%d)\n",
-            __FILE__,
-            MAP_MINIMUM_SIZE
+            LOG_DEBUG,
+            "[%s] get_node_hashed() - key does not exist\n",
+            __FILE__
         );
-
-        size = MAP_MINIMUM_SIZE;
     }
-    else if (!is_power_of_two(size)){
+    else if (status == M_STATUS_TYPE_MISMATCH){
         log_write(
             logger,
             LOG_WARNING,
-            "[%s] map_resize() - size must be a power of 2\n",
+            "[%s] get_node_hashed() - node type does *not* match\n",
             __FILE__
         );
-
-        return false;
     }
 
-    node **nodes = calloc(size, sizeof(*nodes));
+    return n;
+}
 
-    if (!nodes){
+static node *get_node(const map *m, size_t size, const void *key, mtype type){
+    if (!m){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] get_node() - map is NULL\n",
+            __FILE__
+        );
+
+        return NULL;
+    }
+    else if (!key){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] get_node() - key is NULL\n",
+            __FILE__
+        );
+
+        return NULL;
+    }
+
+    return get_node_hashed(m, generate_hash(m, size, key), size, key, type);
+}
+
+/* starts loading the control bytes and slots hash probes first */
+static void prefetch_slot(const map *m, map_hash hash){
+    if (m->probe == M_PROBE_ROBIN_HOOD){
+        size_t slot = hash & (m->table.size - 1);
+
+        __builtin_prefetch(m->table.ctrl + slot);
+        __builtin_prefetch(m->table.slots + slot);
+    }
+    else {
+        size_t group = hash_group(hash) & (group_count(m->table.size) - 1);
+
+        __builtin_prefetch(m->table.ctrl + group * MAP_GROUP_WIDTH);
+        __builtin_prefetch(m->table.slots + group * MAP_GROUP_WIDTH);
+    }
+}
+
+/*
+ * pulls in the control bytes and slot for hash and, when its first
+ * group already has a candidate, the node it points at
+ */
+static void prefetch_node(const map *m, map_hash hash){
+    const map_table *t = &m->table;
+
+    if (m->probe == M_PROBE_ROBIN_HOOD){
+        size_t index = hash & (t->size - 1);
+
+        if (t->ctrl[index] >= 0){
+            __builtin_prefetch(m->nodes + t->slots[index]);
+        }
+
+        return;
+    }
+
+    size_t group = hash_group(hash) & (group_count(t->size) - 1);
+    uint32_t matches = group_match(t->ctrl + group * MAP_GROUP_WIDTH, hash_fragment(hash));
+
+    if (matches){
+        __builtin_prefetch(m->nodes + t->slots[group * MAP_GROUP_WIDTH + __builtin_ctz(matches)]);
+    }
+}
+
+uint64_t map_hash_spooky(const void *data, size_t size, uint64_t seed){
+    return spooky_hash64(data, size, seed);
+}
+
+uint64_t map_hash_murmur3(const void *data, size_t size, uint64_t seed){
+    uint64_t out[2];
+
+    MurmurHash3_x64_128(data, size, seed, out);
+
+    return out[0];
+}
+
+uint64_t map_hash_wyhash(const void *data, size_t size, uint64_t seed){
+    return wyhash(data, size, seed);
+}
+
+map *map_init(void){
+    return map_init_ex(NULL);
+}
+
+map *map_init_arena(void){
+    map_options options = {0};
+    options.arena = true;
+
+    return map_init_ex(&options);
+}
+
+map *map_init_ex(const map_options *options){
+    if (MAP_MINIMUM_SIZE <= 0){
+        log_write(
+            logger,
+            LOG_ERROR,
+            "[%s] map_init_ex() - MAP_MINIMUM_SIZE must be greater than 0\n",
+            __FILE__
+        );
+
+        return NULL;
+    }
+    else if (!is_power_of_two(MAP_MINIMUM_SIZE)){
+        log_write(
+            logger,
+            LOG_ERROR,
+            "[%s] map_init_ex() - MAP_MINIMUM_SIZE must be a power of 2\n",
+            __FILE__
+        );
+
+        return NULL;
+    }
+
+
+    map *m = calloc(1, sizeof(*m));
+
+    if (!m){
+        log_write(
+            logger,
+            LOG_ERROR,
+            "[%s] map_init_ex() - map alloc failed\n",
+            __FILE__
+        );
+
+        return NULL;
+    }
+
+    m->probe = options ? options->probe : M_PROBE_GROUP;
+    m->resize = options ? options->resize : M_RESIZE_SYNC;
+
+    m->length = 0;
+
+    if (!table_init(&m->table, MAP_MINIMUM_SIZE)){
+        log_write(
+            logger,
+            LOG_ERROR,
+            "[%s] map_init_ex() - table alloc failed\n",
+            __FILE__
+        );
+
+        free(m);
+
+        return NULL;
+    }
+
+    m->hasher = options && options->hasher ? options->hasher : map_hash_spooky;
+    m->nodes = malloc(MAP_MINIMUM_SIZE * sizeof(*m->nodes));
+
+    if (!m->nodes){
+        log_write(
+            logger,
+            LOG_ERROR,
+            "[%s] map_init_ex() - nodes alloc failed\n",
+            __FILE__
+        );
+
+        table_free(&m->table);
+        free(m);
+
+        return NULL;
+    }
+
+    m->nodeslength = 0;
+    m->nodessize = MAP_MINIMUM_SIZE;
+
+    if (options && options->arena){
+        m->arena = malloc(sizeof(*m->arena) + MAP_ARENA_MINIMUM_BLOCK);
+
+        if (!m->arena){
+            log_write(
+                logger,
+                LOG_ERROR,
+                "[%s] map_init_ex() - arena alloc failed\n",
+                __FILE__
+            );
+
+            free(m->nodes);
+            table_free(&m->table);
+            free(m);
+
+            return NULL;
+        }
+
+        m->arena->next = NULL;
+        m->arena->size = MAP_ARENA_MINIMUM_BLOCK;
+        m->arena->used = 0;
+    }
+
+    m->seed = (uint64_t)&m;
+
+    if (options && options->atoms){
+        /* same hash as the atoms themselves so it never has to be recomputed */
+        m->atoms = true;
+        m->hasher = map_hash_wyhash;
+        m->seed = ATOM_HASH_SEED;
+    }
+
+    if (options && options->filter){
+        m->filter = filter_init(options->filter, FILTER_DEFAULT_RATE);
+
+        if (!m->filter){
+            log_write(
+                logger,
+                LOG_ERROR,
+                "[%s] map_init_ex() - filter initialization failed\n",
+                __FILE__
+            );
+
+            map_free(m);
+
+            return NULL;
+        }
+    }
+
+    return m;
+}
+
+map *map_copy(const map *m){
+    if (!m){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] map_copy() - map is NULL\n",
+            __FILE__
+        );
+
+        return NULL;
+    }
+
+    map_options options = {0};
+    options.probe = m->probe;
+    options.resize = m->resize;
+    options.hasher = m->hasher;
+    options.arena = m->arena != NULL;
+    options.atoms = m->atoms;
+
+    map *copy = map_init_ex(&options);
+
+    if (!copy){
+        log_write(
+            logger,
+            LOG_ERROR,
+            "[%s] map_copy() - map intiialization failed\n",
+            __FILE__
+        );
+
+        return NULL;
+    }
+
+    /* same seed and hasher so the index can be copied as it is */
+    copy->seed = m->seed;
+
+    if (m->filter){
+        copy->filter = filter_copy(m->filter);
+
+        if (!copy->filter){
+            log_write(
+                logger,
+                LOG_ERROR,
+                "[%s] map_copy() - filter_copy call failed\n",
+                __FILE__
+            );
+
+            map_free(copy);
+
+            return NULL;
+        }
+    }
+
+    map_table table;
+
+    if (!table_init(&table, m->table.size)){
+        log_write(
+            logger,
+            LOG_ERROR,
+            "[%s] map_copy() - table alloc failed\n",
+            __FILE__
+        );
+
+        map_free(copy);
+
+        return NULL;
+    }
+
+    table_free(&copy->table);
+
+    copy->table = table;
+
+    if (!nodes_resize(copy, m->nodessize)){
+        log_write(
+            logger,
+            LOG_ERROR,
+            "[%s] map_copy() - nodes_resize call failed\n",
+            __FILE__
+        );
+
+        map_free(copy);
+
+        return NULL;
+    }
+
+    if (m->rehash.ctrl || m->nodeslength != m->length){
+        /* holes or a pending resize -- index the packed nodes from scratch */
+        if (!table_build(m, &copy->table)){
+            log_write(
+                logger,
+                LOG_ERROR,
+                "[%s] map_copy() - table_build call failed\n",
+                __FILE__
+            );
+
+            map_free(copy);
+
+            return NULL;
+        }
+    }
+    else {
+        memcpy(copy->table.ctrl, m->table.ctrl, group_count(m->table.size) * MAP_GROUP_WIDTH);
+        memcpy(copy->table.slots, m->table.slots, m->table.size * sizeof(*m->table.slots));
+
+        copy->table.deleted = m->table.deleted;
+    }
+
+    for (size_t index = 0; index < m->nodeslength; ++index){
+        const node *n = m->nodes + index;
+
+        if (node_is_hole(n)){
+            continue;
+        }
+
+        node *hold = copy->nodes + copy->nodeslength;
+
+        hold->hash = n->hash;
+
+        /* atoms outlive every map, keys the atom table turned away are copied */
+        bool keyinit = m->atoms && key_is_atom(&n->key)
+            ? item_init_borrowed(&hold->key, n->key.type, n->key.size, n->key.data)
+            : item_init(copy, &hold->key, n->key.type, n->key.size, item_get_data(&n->key), n->key.generic_free);
+
+        if (!keyinit){
+            log_write(
+                logger,
+                LOG_ERROR,
+                "[%s] map_copy() - key copy failed\n",
+                __FILE__
+            );
+
+            map_free(copy);
+
+            return NULL;
+        }
+
+        if (!item_init(copy, &hold->value, n->value.type, n->value.size, item_get_data(&n->value), n->value.generic_free)){
+            log_write(
+                logger,
+                LOG_ERROR,
+                "[%s] map_copy() - value copy failed\n",
+                __FILE__
+            );
+
+            item_free(&hold->key);
+            map_free(copy);
+
+            return NULL;
+        }
+
+        ++copy->nodeslength;
+        ++copy->length;
+    }
+
+    return copy;
+}
+
+bool map_resize(map *m, size_t size){
+    if (!m){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] map_resize() - map is NULL\n",
+            __FILE__
+        );
+
+        return false;
+    }
+    else if (size == 0 || size < MAP_MINIMUM_SIZE){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] map_resize() - size cannot be 0 or less than MAP_MINIMUM_SIZE -- set to MAP_MINIMUM_SIZE (%d)\n",
+            __FILE__,
+            MAP_MINIMUM_SIZE
+        );
+
+        size = MAP_MINIMUM_SIZE;
+    }
+    else if (!is_power_of_two(size)){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] map_resize() - size must be a power of 2\n",
+            __FILE__
+        );
+
+        return false;
+    }
+
+    if ((double)m->length / (double)size >= MAP_GROWTH_LOAD_FACTOR){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] map_resize() - size (%ld) is too small for map length (%ld)\n",
+            __FILE__,
+            size,
+            m->length
+        );
+
+        return false;
+    }
+
+    map_table table;
+
+    if (!table_init(&table, size)){
+        log_write(
+            logger,
+            LOG_ERROR,
+            "[%s] map_resize() - table alloc failed\n",
+            __FILE__
+        );
+
+        return false;
+    }
+
+    /*
+     * the index is rebuilt from the nodes so this also finishes an
+     * incremental resize that is still in progress
+     */
+    if (!table_build(m, &table)){
+        log_write(
+            logger,
+            LOG_ERROR,
+            "[%s] map_resize() - probe limit reached while rehashing\n",
+            __FILE__
+        );
+
+        table_free(&table);
+
+        return false;
+    }
+
+    nodes_compact(m);
+
+    table_free(&m->table);
+    table_free(&m->rehash);
+
+    m->table = table;
+    m->rehashindex = 0;
+
+    ++m->resizes;
+
+    return true;
+}
+
+bool map_reserve(map *m, size_t length){
+    if (!m){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] map_reserve() - map is NULL\n",
+            __FILE__
+        );
+
+        return false;
+    }
+
+    return reserve(m, length);
+}
+
+bool map_rehash_step(map *m, size_t count){
+    if (!m){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] map_rehash_step() - map is NULL\n",
+            __FILE__
+        );
+
+        return false;
+    }
+
+    if (!rehash_step(m, count)){
+        return map_resize(m, m->table.size << 1);
+    }
+
+    return true;
+}
+
+size_t map_get_length(const map *m){
+    if (!m){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] map_get_length() - map is NULL\n",
+            __FILE__
+        );
+
+        return 0;
+    }
+
+    return m->length;
+}
+
+size_t map_get_size(const map *m){
+    if (!m){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] map_get_size() - map is NULL\n",
+            __FILE__
+        );
+
+        return 0;
+    }
+
+    return m->table.size;
+}
+
+/* groups or slots between the home of the node in index and index */
+static size_t slot_probe_length(const map *m, const map_table *t, size_t index){
+    if (m->probe == M_PROBE_ROBIN_HOOD){
+        return (size_t)t->ctrl[index];
+    }
+
+    size_t mask = group_count(t->size) - 1;
+    size_t group = hash_group(m->nodes[t->slots[index]].hash) & mask;
+    size_t probe = 0;
+
+    while (group != index / MAP_GROUP_WIDTH && probe <= mask){
+        group = (group + probe + 1) & mask;
+
+        ++probe;
+    }
+
+    return probe;
+}
+
+static void table_stats(const map *m, const map_table *t, mstats *stats, size_t *probes){
+    if (!t->ctrl){
+        return;
+    }
+
+    stats->slotbytes += group_count(t->size) * MAP_GROUP_WIDTH + t->size * sizeof(*t->slots);
+    stats->tombstones += t->deleted;
+
+    for (size_t index = 0; index < t->size; ++index){
+        if (t->ctrl[index] < 0){
+            continue;
+        }
+
+        size_t probe = slot_probe_length(m, t, index);
+
+        ++stats->probes[probe < MAP_STATS_PROBES ? probe : MAP_STATS_PROBES - 1];
+
+        if (probe > stats->maxprobe){
+            stats->maxprobe = probe;
+        }
+
+        *probes += probe;
+    }
+}
+
+bool map_stats(const map *m, mstats *stats){
+    if (!m){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] map_stats() - map is NULL\n",
+            __FILE__
+        );
+
+        return false;
+    }
+    else if (!stats){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] map_stats() - stats is NULL -- unable to assign\n",
+            __FILE__
+        );
+
+        return false;
+    }
+
+    memset(stats, 0, sizeof(*stats));
+
+    stats->length = m->length;
+    stats->slots = m->table.size;
+    stats->load = (double)m->length / (double)m->table.size;
+    stats->holes = m->nodeslength - m->length;
+    stats->resizes = m->resizes;
+    stats->rehashing = m->rehash.ctrl != NULL;
+
+    size_t probes = 0;
+
+    table_stats(m, &m->table, stats, &probes);
+    table_stats(m, &m->rehash, stats, &probes);
+
+    /* entries still in the old table are counted there */
+    stats->meanprobe = m->length ? (double)probes / (double)m->length : 0.0;
+
+    stats->nodebytes = m->nodessize * sizeof(*m->nodes);
+
+    for (size_t index = 0; index < m->nodeslength; ++index){
+        const node *n = m->nodes + index;
+
+        if (node_is_hole(n)){
+            continue;
+        }
+
+        stats->keybytes += n->key.size;
+        stats->valuebytes += n->value.size;
+    }
+
+    if (m->filter){
+        stats->filterbytes = filter_get_bytes(m->filter);
+    }
+
+    stats->hits = __atomic_load_n(&m->hits, __ATOMIC_RELAXED);
+    stats->misses = __atomic_load_n(&m->misses, __ATOMIC_RELAXED);
+
+    return true;
+}
+
+mapiter *map_iter_init(const map *m){
+    if (!m){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] map_iter_init() - map is NULL\n",
+            __FILE__
+        );
+
+        return NULL;
+    }
+
+    mapiter *iter = malloc(sizeof(*iter));
+
+    if (!iter){
+        log_write(
+            logger,
+            LOG_ERROR,
+            "[%s] map_iter_init() - iterator alloc failed\n",
+            __FILE__
+        );
+
+        return NULL;
+    }
+
+    iter->m = m;
+    iter->n = NULL;
+
+    return iter;
+}
+
+bool map_iter_is_last(const mapiter *iter){
+    if (!iter){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] map_iter_is_last() - iterator is NULL\n",
+            __FILE__
+        );
+
+        return false;
+    }
+    else if (!iter->m){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] map_iter_is_last() - map is NULL\n",
+            __FILE__
+        );
+
+        return false;
+    }
+    else if (!iter->n){
+        log_write(
+            logger,
+            LOG_DEBUG,
+            "[%s] map_iter_is_last() - node is NULL -- map_iter_next hasn't been called or map is empty\n",
+            __FILE__
+        );
+
+        return false;
+    }
+
+    const map *m = iter->m;
+
+    /* trailing holes are never kept so the last node is always live */
+    return iter->n == m->nodes + m->nodeslength - 1;
+}
+
+bool map_iter_get_key(const mapiter *iter, map_item *key){
+    if (!iter){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] map_iter_get_key() - iterator is NULL\n",
+            __FILE__
+        );
+
+        return false;
+    }
+    else if (!iter->m){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] map_iter_get_key() - map is NULL\n",
+            __FILE__
+        );
+
+        return false;
+    }
+    else if (!iter->n){
+        log_write(
+            logger,
+            LOG_DEBUG,
+            "[%s] map_iter_get_key() - node is NULL -- map_iter_next hasn't been called or map is empty\n",
+            __FILE__
+        );
+
+        return false;
+    }
+    else if (!key){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] map_iter_get_key() - key is NULL -- unable to assign\n",
+            __FILE__
+        );
+
+        return false;
+    }
+
+    item_view(key, &iter->n->key);
+
+    return true;
+}
+
+bool map_iter_get_value(const mapiter *iter, map_item *value){
+    if (!iter){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] map_iter_get_value() - iterator is NULL\n",
+            __FILE__
+        );
+
+        return false;
+    }
+    else if (!iter->m){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] map_iter_get_value() - map is NULL\n",
+            __FILE__
+        );
+
+        return false;
+    }
+    else if (!iter->n){
+        log_write(
+            logger,
+            LOG_DEBUG,
+            "[%s] map_iter_get_value() - node is NULL -- map_iter_next hasn't been called or map is empty\n",
+            __FILE__
+        );
+
+        return false;
+    }
+    else if (!value){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] map_iter_get_value() - value is NULL -- unable to assign\n",
+            __FILE__
+        );
+
+        return false;
+    }
+
+    item_view(value, &iter->n->value);
+
+    return true;
+}
+
+bool map_iter_next(mapiter *iter){
+    if (!iter){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] map_iter_next() - iterator is NULL\n",
+            __FILE__
+        );
+
+        return false;
+    }
+    else if (!iter->m){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] map_iter_next() - map is NULL\n",
+            __FILE__
+        );
+
+        return false;
+    }
+
+    const map *m = iter->m;
+    size_t index = iter->n ? (size_t)(iter->n - m->nodes) + 1 : 0;
+
+    while (index < m->nodeslength && node_is_hole(m->nodes + index)){
+        ++index;
+    }
+
+    iter->n = index < m->nodeslength ? m->nodes + index : NULL;
+
+    return iter->n ? true : false;
+}
+
+bool map_iter_prev(mapiter *iter){
+    if (!iter){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] map_iter_prev() - iterator is NULL\n",
+            __FILE__
+        );
+
+        return false;
+    }
+    else if (!iter->m){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] map_iter_prev() - map is NULL\n",
+            __FILE__
+        );
+
+        return false;
+    }
+
+    const map *m = iter->m;
+    size_t index = iter->n ? (size_t)(iter->n - m->nodes) : m->nodeslength;
+
+    while (index && node_is_hole(m->nodes + index - 1)){
+        --index;
+    }
+
+    iter->n = index ? m->nodes + index - 1 : NULL;
+
+    return iter->n ? true : false;
+}
+
+void map_iter_free(mapiter *iter){
+    if (!iter){
+        log_write(
+            logger,
+            LOG_DEBUG,
+            "[%s] map_iter_free() - iterator is NULL\n",
+            __FILE__
+        );
+
+        return;
+    }
+
+    free(iter);
+}
+
+mstatus map_try_get(const map *m, size_t size, const void *key, mtype type, const map_item **value){
+    if (!m || !key){
+        return M_STATUS_INVALID;
+    }
+
+    return map_try_get_prehashed(m, generate_hash(m, size, key), size, key, type, value);
+}
+
+mstatus map_try_get_prehashed(const map *m, map_hash hash, size_t size, const void *key, mtype type, const map_item **value){
+    node *n = NULL;
+    mstatus status = try_get_node(m, hash, size, key, type, &n);
+
+    if (value){
+        *value = n ? &n->value : NULL;
+    }
+
+    return status;
+}
+
+bool map_item_init(map_item *i, const map_item *value){
+    return item_init_value(NULL, i, value);
+}
+
+void map_item_free(map_item *i){
+    item_free(i);
+}
+
+const void *map_item_get_data(const map_item *i){
+    if (!i){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] map_item_get_data() - item is NULL\n",
+            __FILE__
+        );
+
+        return NULL;
+    }
+
+    return item_get_data(i);
+}
+
+bool map_contains(const map *m, size_t size, const void *key){
+    mstatus status = map_try_get(m, size, key, M_TYPE_RESERVED_EMPTY, NULL);
+
+    return status == M_STATUS_OK;
+}
+
+mtype map_get_type(const map *m, size_t size, const void *key){
+    const node *n = get_node(m, size, key, M_TYPE_RESERVED_EMPTY);
+
+    if (!n){
+        return M_TYPE_RESERVED_ERROR;
+    }
+
+    return n->value.type;
+}
+
+bool map_get_bool(const map *m, size_t size, const void *key){
+    const node *n = get_node(m, size, key, M_TYPE_BOOL);
+
+    if (!n){
+        return false;
+    }
+
+    return *(bool *)item_get_data(&n->value);
+}
+
+char map_get_char(const map *m, size_t size, const void *key){
+    const node *n = get_node(m, size, key, M_TYPE_CHAR);
+
+    if (!n){
+        return 0;
+    }
+
+    return *(char *)item_get_data(&n->value);
+}
+
+double map_get_double(const map *m, size_t size, const void *key){
+    const node *n = get_node(m, size, key, M_TYPE_DOUBLE);
+
+    if (!n){
+        return 0.0;
+    }
+
+    return *(double *)item_get_data(&n->value);
+}
+
+int64_t map_get_int(const map *m, size_t size, const void *key){
+    const node *n = get_node(m, size, key, M_TYPE_INT);
+
+    if (!n){
+        return 0;
+    }
+
+    return *(int64_t *)item_get_data(&n->value);
+}
+
+uint64_t map_get_uint(const map *m, size_t size, const void *key){
+    const node *n = get_node(m, size, key, M_TYPE_UINT);
+
+    if (!n){
+        return 0;
+    }
+
+    return *(uint64_t *)item_get_data(&n->value);
+}
+
+size_t map_get_size_t(const map *m, size_t size, const void *key){
+    const node *n = get_node(m, size, key, M_TYPE_SIZE_T);
+
+    if (!n){
+        return 0;
+    }
+
+    return *(size_t *)item_get_data(&n->value);
+}
+
+/*
+ * READ WARNING FOR THESE FUNCTIONS IN HEADER FILE
+ */
+char *map_get_string(const map *m, size_t size, const void *key){
+    const node *n = get_node(m, size, key, M_TYPE_STRING);
+
+    if (!n){
+        return NULL;
+    }
+
+    return n->value.data;
+}
+
+list *map_get_list(const map *m, size_t size, const void *key){
+    const node *n = get_node(m, size, key, M_TYPE_LIST);
+
+    if (!n){
+        return NULL;
+    }
+
+    return n->value.data;
+}
+
+map *map_get_map(const map *m, size_t size, const void *key){
+    const node *n = get_node(m, size, key, M_TYPE_MAP);
+
+    if (!n){
+        return NULL;
+    }
+
+    return n->value.data;
+}
+
+void *map_get_generic(const map *m, size_t size, const void *key){
+    const node *n = get_node(m, size, key, M_TYPE_GENERIC);
+
+    if (!n){
+        return NULL;
+    }
+
+    return n->value.data;
+}
+
+map_hash map_hash_key(const map *m, size_t size, const void *key){
+    if (!m){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] map_hash_key() - map is NULL\n",
+            __FILE__
+        );
+
+        return 0;
+    }
+    else if (!key){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] map_hash_key() - key is NULL\n",
+            __FILE__
+        );
+
+        return 0;
+    }
+
+    return generate_hash(m, size, key);
+}
+
+bool map_contains_prehashed(const map *m, map_hash hash, size_t size, const void *key){
+    mstatus status = map_try_get_prehashed(m, hash, size, key, M_TYPE_RESERVED_EMPTY, NULL);
+
+    return status == M_STATUS_OK;
+}
+
+mtype map_get_prehashed_type(const map *m, map_hash hash, size_t size, const void *key){
+    const node *n = get_node_hashed(m, hash, size, key, M_TYPE_RESERVED_EMPTY);
+
+    if (!n){
+        return M_TYPE_RESERVED_ERROR;
+    }
+
+    return n->value.type;
+}
+
+bool map_get_prehashed_bool(const map *m, map_hash hash, size_t size, const void *key){
+    const node *n = get_node_hashed(m, hash, size, key, M_TYPE_BOOL);
+
+    if (!n){
+        return false;
+    }
+
+    return *(bool *)item_get_data(&n->value);
+}
+
+char map_get_prehashed_char(const map *m, map_hash hash, size_t size, const void *key){
+    const node *n = get_node_hashed(m, hash, size, key, M_TYPE_CHAR);
+
+    if (!n){
+        return 0;
+    }
+
+    return *(char *)item_get_data(&n->value);
+}
+
+double map_get_prehashed_double(const map *m, map_hash hash, size_t size, const void *key){
+    const node *n = get_node_hashed(m, hash, size, key, M_TYPE_DOUBLE);
+
+    if (!n){
+        return 0.0;
+    }
+
+    return *(double *)item_get_data(&n->value);
+}
+
+int64_t map_get_prehashed_int(const map *m, map_hash hash, size_t size, const void *key){
+    const node *n = get_node_hashed(m, hash, size, key, M_TYPE_INT);
+
+    if (!n){
+        return 0;
+    }
+
+    return *(int64_t *)item_get_data(&n->value);
+}
+
+uint64_t map_get_prehashed_uint(const map *m, map_hash hash, size_t size, const void *key){
+    const node *n = get_node_hashed(m, hash, size, key, M_TYPE_UINT);
+
+    if (!n){
+        return 0;
+    }
+
+    return *(uint64_t *)item_get_data(&n->value);
+}
+
+size_t map_get_prehashed_size_t(const map *m, map_hash hash, size_t size, const void *key){
+    const node *n = get_node_hashed(m, hash, size, key, M_TYPE_SIZE_T);
+
+    if (!n){
+        return 0;
+    }
+
+    return *(size_t *)item_get_data(&n->value);
+}
+
+/*
+ * READ WARNING FOR THESE FUNCTIONS IN HEADER FILE
+ */
+char *map_get_prehashed_string(const map *m, map_hash hash, size_t size, const void *key){
+    const node *n = get_node_hashed(m, hash, size, key, M_TYPE_STRING);
+
+    if (!n){
+        return NULL;
+    }
+
+    return n->value.data;
+}
+
+list *map_get_prehashed_list(const map *m, map_hash hash, size_t size, const void *key){
+    const node *n = get_node_hashed(m, hash, size, key, M_TYPE_LIST);
+
+    if (!n){
+        return NULL;
+    }
+
+    return n->value.data;
+}
+
+map *map_get_prehashed_map(const map *m, map_hash hash, size_t size, const void *key){
+    const node *n = get_node_hashed(m, hash, size, key, M_TYPE_MAP);
+
+    if (!n){
+        return NULL;
+    }
+
+    return n->value.data;
+}
+
+void *map_get_prehashed_generic(const map *m, map_hash hash, size_t size, const void *key){
+    const node *n = get_node_hashed(m, hash, size, key, M_TYPE_GENERIC);
+
+    if (!n){
+        return NULL;
+    }
+
+    return n->value.data;
+}
+
+size_t map_get_many(const map *m, size_t count, const void *const *keys, const size_t *sizes, map_item *values){
+    if (!m){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] map_get_many() - map is NULL\n",
+            __FILE__
+        );
+
+        return 0;
+    }
+    else if (!keys || !sizes || !values){
         log_write(
             logger,
-            LOG_ERROR,
-            "[%s] map_resize() - nodes alloc failed\n",
+            LOG_WARNING,
+            "[%s] map_get_many() - keys, sizes or values is NULL\n",
             __FILE__
         );
 
-        return false;
+        return 0;
     }
 
-    for (size_t index = 0; index < m->size; ++index){
-        node *n = m->nodes[index];
+    size_t found = 0;
+    map_hash hashes[MAP_BATCH_SIZE];
 
-        if (!n){
-            continue;
-        }
+    for (size_t start = 0; start < count; start += MAP_BATCH_SIZE){
+        size_t batch = count - start < MAP_BATCH_SIZE ? count - start : MAP_BATCH_SIZE;
 
-        if (index > size){
-            if (n->prev){
-                n->prev->next = n->next;
+        /* hash the whole batch and start loading every control group, NULL keys just miss */
+        for (size_t index = 0; index < batch; ++index){
+            if (!keys[start + index]){
+                continue;
             }
 
-            node_free(n);
+            hashes[index] = generate_hash(m, sizes[start + index], keys[start + index]);
 
-            --m->length;
+            prefetch_slot(m, hashes[index]);
+        }
 
-            continue;
+        /* by now the groups have arrived -- start loading the nodes */
+        for (size_t index = 0; index < batch; ++index){
+            if (keys[start + index]){
+                prefetch_node(m, hashes[index]);
+            }
         }
 
-        size_t newindex = generate_index(n->hash, size);
-        node *hold = nodes[newindex];
+        for (size_t index = 0; index < batch; ++index){
+            const void *key = keys[start + index];
+            map_item *value = values + start + index;
+            const node *n = key ? find_node(m, hashes[index], sizes[start + index], key) : NULL;
 
-        for (size_t count = 0; count < size; ++count){
-            if (!hold){
-                break;
+            count_lookup(m, n != NULL);
+
+            if (n){
+                item_view(value, &n->value);
+
+                ++found;
             }
+            else {
+                memset(value, 0, sizeof(*value));
 
-            newindex = generate_index(newindex, size);
-            hold = nodes[newindex];
+                value->type = M_TYPE_RESERVED_ERROR;
+            }
         }
-
-        nodes[newindex] = n;
     }
 
-    free(m->nodes);
+    return found;
+}
 
-    m->nodes = nodes;
-    m->size = size;
+/* called once the node is in -- a full filter is rebuilt from the live nodes */
+static void filter_insert(map *m, uint64_t hash){
+    if (filter_get_length(m->filter) < filter_get_capacity(m->filter)){
+        filter_add_hash(m->filter, hash, filter_bits(hash));
 
-    return true;
-}
+        return;
+    }
 
-size_t map_get_length(const map *m){
-    if (!m){
-        log_write(
-            logger,
-            LOG_WARNING,
-            "[%s] map_get_length() - map is NULL\n",
-            __FILE__
-        );
+    size_t capacity = filter_get_capacity(m->filter);
 
-        return 0;
+    if (capacity < m->length * 2){
+        capacity = m->length * 2;
     }
 
-    return m->length;
+    filter_rebuild(m, capacity);
 }
 
-size_t map_get_size(const map *m){
-    if (!m){
-        log_write(
-            logger,
-            LOG_WARNING,
-            "[%s] map_get_size() - map is NULL\n",
-            __FILE__
-        );
+static bool set_node(map *m, uint64_t hash, const map_item *key, const void *keydata, const map_item *value, bool borrowed){
+    incremental_advance(m);
 
-        return 0;
-    }
+    node *n = find_node(m, hash, key->size, keydata);
 
-    return m->size;
-}
+    if (n){
+        map_item tmp;
 
-mapiter *map_iter_init(const map *m){
-    if (!m){
-        log_write(
-            logger,
-            LOG_WARNING,
-            "[%s] map_iter_init() - map is NULL\n",
-            __FILE__
-        );
+        if (!item_init_value(m, &tmp, value)){
+            log_write(
+                logger,
+                LOG_ERROR,
+                "[%s] set_node() - item initialization failed\n",
+                __FILE__
+            );
 
-        return NULL;
-    }
+            return false;
+        }
 
-    mapiter *iter = malloc(sizeof(*iter));
+        item_free(&n->value);
 
-    if (!iter){
+        n->value = tmp;
+
+        return true;
+    }
+
+    if (!check_availability(m)){
         log_write(
             logger,
             LOG_ERROR,
-            "[%s] map_iter_init() - iterator alloc failed\n",
+            "[%s] set_node() - check_availability call failed\n",
             __FILE__
         );
 
-        return NULL;
+        return false;
     }
 
-    iter->m = m;
-    iter->n = NULL;
+    node hold;
 
-    return iter;
-}
+    bool keyinit = borrowed
+        ? item_init_borrowed(&hold.key, key->type, key->size, keydata)
+        : item_init(m, &hold.key, key->type, key->size, keydata, key->generic_free);
 
-bool map_iter_is_last(const mapiter *iter){
-    if (!iter){
+    if (!keyinit){
         log_write(
             logger,
-            LOG_WARNING,
-            "[%s] map_iter_is_last() - iterator is NULL\n",
+            LOG_ERROR,
+            "[%s] set_node() - key initialization failed\n",
             __FILE__
         );
 
         return false;
     }
-    else if (!iter->m){
-        log_write(
-            logger,
-            LOG_WARNING,
-            "[%s] map_iter_is_last() - map is NULL\n",
-            __FILE__
-        );
 
-        return false;
-    }
-    else if (!iter->n){
+    if (!item_init_value(m, &hold.value, value)){
         log_write(
             logger,
-            LOG_DEBUG,
-            "[%s] map_iter_is_last() - node is NULL -- map_iter_next hasn't been called or map is empty\n",
+            LOG_ERROR,
+            "[%s] set_node() - value initialization failed\n",
             __FILE__
         );
 
+        item_free(&hold.key);
+
         return false;
     }
 
-    return iter->n == iter->m->last;
-}
+    size_t index;
 
-bool map_iter_get_key(const mapiter *iter, map_item *key){
-    if (!iter){
-        log_write(
-            logger,
-            LOG_WARNING,
-            "[%s] map_iter_get_key() - iterator is NULL\n",
-            __FILE__
-        );
+    while ((index = insert_slot(m, &m->table, hash)) == SIZE_MAX){
+        if (!map_resize(m, m->table.size << 1)){
+            log_write(
+                logger,
+                LOG_ERROR,
+                "[%s] set_node() - map_resize call failed\n",
+                __FILE__
+            );
 
-        return false;
-    }
-    else if (!iter->m){
-        log_write(
-            logger,
-            LOG_WARNING,
-            "[%s] map_iter_get_key() - map is NULL\n",
-            __FILE__
-        );
+            item_free(&hold.key);
+            item_free(&hold.value);
 
-        return false;
+            return false;
+        }
     }
-    else if (!iter->n){
-        log_write(
-            logger,
-            LOG_DEBUG,
-            "[%s] map_iter_get_key() - node is NULL -- map_iter_next hasn't been called or map is empty\n",
-            __FILE__
-        );
 
-        return false;
-    }
-    else if (!key){
-        log_write(
-            logger,
-            LOG_WARNING,
-            "[%s] map_iter_get_key() - key is NULL -- unable to assign\n",
-            __FILE__
-        );
+    hold.hash = hash;
 
-        return false;
-    }
+    m->table.slots[index] = m->nodeslength;
+    m->nodes[m->nodeslength++] = hold;
+
+    ++m->length;
 
-    *key = *iter->n->key;
+    if (m->filter){
+        filter_insert(m, hash);
+    }
 
     return true;
 }
 
-bool map_iter_get_value(const mapiter *iter, map_item *value){
-    if (!iter){
+bool map_set(map *m, const map_item *key, const map_item *value){
+    if (!m){
         log_write(
             logger,
             LOG_WARNING,
-            "[%s] map_iter_get_value() - iterator is NULL\n",
+            "[%s] map_set() - map is NULL\n",
             __FILE__
         );
 
         return false;
     }
-    else if (!iter->m){
+    else if (!key){
         log_write(
             logger,
             LOG_WARNING,
-            "[%s] map_iter_get_value() - map is NULL\n",
-            __FILE__
-        );
-
-        return false;
-    }
-    else if (!iter->n){
-        log_write(
-            logger,
-            LOG_DEBUG,
-            "[%s] map_iter_get_value() - node is NULL -- map_iter_next hasn't been called or map is empty\n",
+            "[%s] map_set() - key is NULL\n",
             __FILE__
         );
 
         return false;
     }
-    else if (!value){
+    else if (key->data){
         log_write(
             logger,
             LOG_WARNING,
-            "[%s] map_iter_get_value() - value is NULL -- unable to assign\n",
+            "[%s] map_set() - key will *always* be copied -- set key in data_copy instead\n",
             __FILE__
         );
 
         return false;
     }
 
-    *value = *iter->n->value;
+    /* a key the atom table turns away is copied, it hashes the same either way */
+    const atom *a = m->atoms ? atom_intern(key->size, key->data_copy) : NULL;
 
-    return true;
+    if (a){
+        return set_node(m, a->hash, key, a->string, value, true);
+    }
+
+    return set_node(m, generate_hash(m, key->size, key->data_copy), key, key->data_copy, value, false);
 }
 
-bool map_iter_next(mapiter *iter){
-    if (!iter){
+bool map_set_prehashed(map *m, map_hash hash, const map_item *key, const map_item *value){
+    if (!m){
         log_write(
             logger,
             LOG_WARNING,
-            "[%s] map_iter_next() - iterator is NULL\n",
+            "[%s] map_set_prehashed() - map is NULL\n",
             __FILE__
         );
 
         return false;
     }
-    else if (!iter->m){
+    else if (!key){
         log_write(
             logger,
             LOG_WARNING,
-            "[%s] map_iter_next() - map is NULL\n",
+            "[%s] map_set_prehashed() - key is NULL\n",
             __FILE__
         );
 
         return false;
     }
-
-    iter->n = iter->n ? iter->n->next : iter->m->first;
-
-    return iter->n ? true : false;
-}
-
-bool map_iter_prev(mapiter *iter){
-    if (!iter){
+    else if (key->data){
         log_write(
             logger,
             LOG_WARNING,
-            "[%s] map_iter_prev() - iterator is NULL\n",
+            "[%s] map_set_prehashed() - key will *always* be copied -- set key in data_copy instead\n",
             __FILE__
         );
 
         return false;
     }
-    else if (!iter->m){
+    else if (m->atoms){
         log_write(
             logger,
             LOG_WARNING,
-            "[%s] map_iter_prev() - map is NULL\n",
+            "[%s] map_set_prehashed() - atom keyed maps intern their keys -- use map_set\n",
             __FILE__
         );
 
         return false;
     }
 
-    iter->n = iter->n ? iter->n->prev : iter->m->last;
-
-    return iter->n ? true : false;
+    return set_node(m, hash, key, key->data_copy, value, false);
 }
 
-void map_iter_free(mapiter *iter){
-    if (!iter){
+bool map_set_borrowed(map *m, const map_item *key, const map_item *value){
+    if (!m){
         log_write(
             logger,
-            LOG_DEBUG,
-            "[%s] map_iter_free() - iterator is NULL\n",
+            LOG_WARNING,
+            "[%s] map_set_borrowed() - map is NULL\n",
             __FILE__
         );
 
-        return;
-    }
-
-    free(iter);
-}
-
-bool map_contains(const map *m, size_t size, const void *key){
-    return get_node(m, size, key, M_TYPE_RESERVED_EMPTY);
-}
-
-mtype map_get_type(const map *m, size_t size, const void *key){
-    const node *n = get_node(m, size, key, M_TYPE_RESERVED_EMPTY);
-
-    if (!n){
-        return M_TYPE_RESERVED_ERROR;
-    }
-
-    return n->value->type;
-}
-
-bool map_get_bool(const map *m, size_t size, const void *key){
-    const node *n = get_node(m, size, key, M_TYPE_BOOL);
-
-    if (!n){
-        return false;
-    }
-
-    return *(bool *)n->value->data;
-}
-
-char map_get_char(const map *m, size_t size, const void *key){
-    const node *n = get_node(m, size, key, M_TYPE_CHAR);
-
-    if (!n){
-        return 0;
-    }
-
-    return *(char *)n->value->data;
-}
-
-double map_get_double(const map *m, size_t size, const void *key){
-    const node *n = get_node(m, size, key, M_TYPE_DOUBLE);
-
-    if (!n){
-        return 0.0;
-    }
-
-    return *(double *)n->value->data;
-}
-
-int64_t map_get_int(const map *m, size_t size, const void *key){
-    const node *n = get_node(m, size, key, M_TYPE_INT);
-
-    if (!n){
-        return 0;
-    }
-
-    return *(int64_t *)n->value->data;
-}
-
-uint64_t map_get_uint(const map *m, size_t size, const void *key){
-    const node *n = get_node(m, size, key, M_TYPE_UINT);
-
-    if (!n){
-        return 0;
-    }
-
-    return *(uint64_t *)n->value->data;
-}
+        return false;
+    }
+    else if (!key){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] map_set_borrowed() - key is NULL\n",
+            __FILE__
+        );
 
-size_t map_get_size_t(const map *m, size_t size, const void *key){
-    const node *n = get_node(m, size, key, M_TYPE_SIZE_T);
+        return false;
+    }
+    else if (!key->data){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] map_set_borrowed() - key is never copied -- set key in data instead\n",
+            __FILE__
+        );
 
-    if (!n){
-        return 0;
+        return false;
     }
 
-    return *(size_t *)n->value->data;
+    return set_node(m, generate_hash(m, key->size, key->data), key, key->data, value, true);
 }
 
-/*
- * READ WARNING FOR THESE FUNCTIONS IN HEADER FILE
- */
-char *map_get_string(const map *m, size_t size, const void *key){
-    const node *n = get_node(m, size, key, M_TYPE_STRING);
+bool map_set_atom(map *m, const atom *a, const map_item *value){
+    if (!m){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] map_set_atom() - map is NULL\n",
+            __FILE__
+        );
 
-    if (!n){
-        return NULL;
+        return false;
     }
+    else if (!a){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] map_set_atom() - atom is NULL\n",
+            __FILE__
+        );
 
-    return n->value->data;
-}
-
-list *map_get_list(const map *m, size_t size, const void *key){
-    const node *n = get_node(m, size, key, M_TYPE_LIST);
+        return false;
+    }
+    else if (!m->atoms){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] map_set_atom() - map is not keyed by atoms\n",
+            __FILE__
+        );
 
-    if (!n){
-        return NULL;
+        return false;
     }
 
-    return n->value->data;
+    map_item key = {0};
+    key.type = M_TYPE_STRING;
+    key.size = a->size;
+
+    return set_node(m, a->hash, &key, a->string, value, true);
 }
 
-map *map_get_map(const map *m, size_t size, const void *key){
-    const node *n = get_node(m, size, key, M_TYPE_MAP);
+/* the key was resolved up front -- atoms are borrowed, everything else is copied into a block */
+typedef struct pending_key {
+    uint64_t hash;
+    const void *data;
+    bool atom;
+} pending_key;
 
-    if (!n){
-        return NULL;
+/* 0 for keys that are stored inline */
+static size_t key_block_size(const map_item *key){
+    if (item_is_inlinable(key->type, key->size)){
+        return 0;
     }
 
-    return n->value->data;
-}
-
-void *map_get_generic(const map *m, size_t size, const void *key){
-    const node *n = get_node(m, size, key, M_TYPE_GENERIC);
+    size_t size = key->type == M_TYPE_STRING ? key->size + 1 : key->size;
 
-    if (!n){
-        return NULL;
+    /* string keys are only read bytewise, others may be read as their type */
+    if (key->type != M_TYPE_STRING){
+        size = (size + _Alignof(max_align_t) - 1) & ~(_Alignof(max_align_t) - 1);
     }
 
-    return n->value->data;
+    return size;
 }
 
-bool map_set(map *m, const map_item *key, const map_item *value){
+size_t map_set_many(map *m, size_t count, const map_item *keys, const map_item *values){
     if (!m){
         log_write(
             logger,
             LOG_WARNING,
-            "[%s] map_set() - map is NULL\n",
+            "[%s] map_set_many() - map is NULL\n",
             __FILE__
         );
 
-        return false;
+        return 0;
     }
-    else if (!key){
+    else if (!keys || !values){
         log_write(
             logger,
             LOG_WARNING,
-            "[%s] map_set() - key is NULL\n",
+            "[%s] map_set_many() - keys or values is NULL\n",
             __FILE__
         );
 
-        return false;
+        return 0;
     }
-    else if (key->data){
+
+    if (!count){
+        return 0;
+    }
+
+    pending_key *pending = malloc(count * sizeof(*pending));
+
+    if (!pending){
         log_write(
             logger,
-            LOG_WARNING,
-            "[%s] map_set() - key will *always* be copied -- set key in data_copy instead\n",
+            LOG_ERROR,
+            "[%s] map_set_many() - pending alloc failed\n",
             __FILE__
         );
 
-        return false;
+        return 0;
     }
 
-    if (!check_availability(m)){
+    size_t blocksize = 0;
+
+    for (size_t index = 0; index < count; ++index){
+        const map_item *key = keys + index;
+
+        if (key->data || !key->data_copy){
+            log_write(
+                logger,
+                LOG_WARNING,
+                "[%s] map_set_many() - key %ld must be set in data_copy\n",
+                __FILE__,
+                index
+            );
+
+            free(pending);
+
+            return 0;
+        }
+
+        const atom *a = m->atoms ? atom_intern(key->size, key->data_copy) : NULL;
+
+        if (a){
+            pending[index].hash = a->hash;
+            pending[index].data = a->string;
+            pending[index].atom = true;
+
+            continue;
+        }
+
+        pending[index].hash = generate_hash(m, key->size, key->data_copy);
+        pending[index].data = key->data_copy;
+        pending[index].atom = false;
+
+        blocksize += key_block_size(key);
+    }
+
+    if (!reserve(m, m->length + count)){
         log_write(
             logger,
             LOG_ERROR,
-            "[%s] map_set() - check_availability call failed\n",
+            "[%s] map_set_many() - reserve call failed\n",
             __FILE__
         );
 
-        return false;
+        free(pending);
+
+        return 0;
     }
 
-    uint32_t hash = generate_hash(m->seed, key->size, key->data_copy);
-    size_t index = generate_index(hash, m->size);
-    node *n = m->nodes[index];
+    /* sized for every key, the ones already present just leave a gap */
+    unsigned char *block = NULL;
 
-    for (size_t count = 0; count < m->size; ++count){
-        if (!n){
-            break;
+    if (blocksize){
+        block = block_alloc(m, blocksize);
+
+        if (!block){
+            log_write(
+                logger,
+                LOG_ERROR,
+                "[%s] map_set_many() - block_alloc call failed\n",
+                __FILE__
+            );
+
+            free(pending);
+
+            return 0;
+        }
+    }
+
+    size_t set = 0;
+
+    for (; set < count; ++set){
+        const map_item *key = keys + set;
+        const pending_key *p = pending + set;
+
+        if (set + MAP_BATCH_SIZE < count){
+            prefetch_slot(m, pending[set + MAP_BATCH_SIZE].hash);
         }
 
-        if (hash == n->hash && !memcmp(key->data_copy, n->key->data, n->key->size)){
-            map_item *tmp = NULL;
+        node *n = find_node(m, p->hash, key->size, p->data);
 
-            if (value->data){
-                tmp = item_init_pointer(
-                    value->type,
-                    value->size,
-                    value->data,
-                    value->generic_free
+        if (n){
+            map_item tmp;
+
+            if (!item_init_value(m, &tmp, values + set)){
+                log_write(
+                    logger,
+                    LOG_ERROR,
+                    "[%s] map_set_many() - item initialization failed\n",
+                    __FILE__
                 );
+
+                break;
             }
-            else {
-                tmp = item_init(
-                    value->type,
-                    value->size,
-                    value->data_copy,
-                    value->generic_free
-                );
+
+            item_free(&n->value);
+
+            n->value = tmp;
+
+            if (block && !p->atom){
+                block += key_block_size(key);
+            }
+
+            continue;
+        }
+
+        node hold;
+
+        if (p->atom){
+            item_init_borrowed(&hold.key, key->type, key->size, p->data);
+        }
+        else if (item_is_inlinable(key->type, key->size)){
+            item_init(m, &hold.key, key->type, key->size, p->data, key->generic_free);
+        }
+        else {
+            /* block copies are marked like borrowed keys so they are never freed one by one */
+            memcpy(block, p->data, key->size);
+
+            if (key->type == M_TYPE_STRING){
+                block[key->size] = '\0';
             }
 
-            if (!tmp){
+            item_init_borrowed(&hold.key, key->type, key->size, block);
+
+            hold.key.generic_free = key->generic_free;
+
+            block += key_block_size(key);
+        }
+
+        if (!item_init_value(m, &hold.value, values + set)){
+            log_write(
+                logger,
+                LOG_ERROR,
+                "[%s] map_set_many() - value initialization failed\n",
+                __FILE__
+            );
+
+            break;
+        }
+
+        size_t index;
+
+        while ((index = insert_slot(m, &m->table, p->hash)) == SIZE_MAX){
+            if (!map_resize(m, m->table.size << 1)){
                 log_write(
                     logger,
                     LOG_ERROR,
-                    "[%s] map_set() - item initialization failed\n",
+                    "[%s] map_set_many() - map_resize call failed\n",
                     __FILE__
                 );
 
-                return false;
+                break;
             }
+        }
 
-            item_free(n->value);
-
-            n->value = tmp;
+        if (index == SIZE_MAX){
+            item_free(&hold.value);
 
-            return true;
+            break;
         }
 
-        index = generate_index(index, m->size);
-        n = m->nodes[index];
+        hold.hash = p->hash;
+
+        m->table.slots[index] = m->nodeslength;
+        m->nodes[m->nodeslength++] = hold;
+
+        ++m->length;
+
+        if (m->filter){
+            filter_insert(m, p->hash);
+        }
     }
 
-    n = node_init(key, value);
+    free(pending);
 
-    if (!n){
+    return set;
+}
+
+map *map_from_arrays(const map_options *options, size_t count, const map_item *keys, const map_item *values){
+    map *m = map_init_ex(options);
+    size_t set = 0;
+
+    if (!m){
         log_write(
             logger,
             LOG_ERROR,
-            "[%s] map_set() - node initialization failed\n",
+            "[%s] map_from_arrays() - map initialization failed\n",
             __FILE__
         );
+    }
+    else {
+        set = map_set_many(m, count, keys, values);
 
-        return false;
+        if (set == count){
+            return m;
+        }
+
+        log_write(
+            logger,
+            LOG_ERROR,
+            "[%s] map_from_arrays() - map_set_many call failed\n",
+            __FILE__
+        );
     }
 
-    n->hash = hash;
-    m->nodes[index] = n;
+    /* release the values that were not taken over yet */
+    for (size_t index = set; values && index < count; ++index){
+        if (values[index].data){
+            map_item unset;
 
-    ++m->length;
+            item_init_pointer(
+                &unset,
+                values[index].type,
+                values[index].size,
+                values[index].data,
+                values[index].generic_free
+            );
 
-    if (m->first){
-        n->prev = m->last;
-        m->last->next = n;
-        m->last = n;
+            item_free(&unset);
+        }
     }
-    else {
-        m->first = n;
-        m->last = n;
+
+    if (m){
+        map_free(m);
     }
 
-    return true;
+    return NULL;
 }
 
-void map_pop(map *m, size_t size, const void *key, map_item *value){
-    node *n = get_node(m, size, key, M_TYPE_RESERVED_EMPTY);
-
+static void pop_node(map *m, node *n, map_item *value){
     if (!n){
         return;
     }
 
     if (value){
-        value->type = n->value->type;
-        value->size = n->value->size;
-        value->data = n->value->data;
-        value->generic_free = n->value->generic_free;
+        value->type = n->value.type;
+        value->size = n->value.size;
+        value->data = n->value.data;
+        value->generic_free = n->value.generic_free;
+
+        if (item_is_borrowed(&n->value)){
+            /* the caller owns a popped value so it has to leave the arena or the node */
+            size_t datasize = n->value.type == M_TYPE_STRING ? n->value.size + 1 : n->value.size;
+
+            value->data = malloc(datasize);
+
+            if (!value->data){
+                log_write(
+                    logger,
+                    LOG_ERROR,
+                    "[%s] pop_node() - value alloc failed\n",
+                    __FILE__
+                );
+
+                value->type = M_TYPE_RESERVED_ERROR;
+
+                return;
+            }
+
+            memcpy(value->data, item_get_data(&n->value), datasize);
+        }
 
         if (value->data){
-            n->value->type = M_TYPE_NULL;
-            n->value->size = 0;
-            n->value->data = NULL;
-            n->value->generic_free = NULL;
+            n->value.type = M_TYPE_NULL;
+            n->value.size = 0;
+            n->value.data = NULL;
+            n->value.generic_free = NULL;
         }
     }
     else {
         log_write(
             logger,
             LOG_DEBUG,
-            "[%s] map_pop() - value is NULL -- removing but unable to assign\n",
+            "[%s] pop_node() - value is NULL -- removing but unable to assign\n",
+            __FILE__
+        );
+    }
+
+    node_remove(m, n);
+
+    incremental_advance(m);
+}
+
+void map_pop(map *m, size_t size, const void *key, map_item *value){
+    pop_node(m, get_node(m, size, key, M_TYPE_RESERVED_EMPTY), value);
+}
+
+void map_pop_prehashed(map *m, map_hash hash, size_t size, const void *key, map_item *value){
+    pop_node(m, get_node_hashed(m, hash, size, key, M_TYPE_RESERVED_EMPTY), value);
+}
+
+static void remove_node(map *m, map_hash hash, size_t size, const void *key){
+    node *n = find_node(m, hash, size, key);
+
+    if (!n){
+        log_write(
+            logger,
+            LOG_DEBUG,
+            "[%s] remove_node() - key does not exist\n",
             __FILE__
         );
+
+        return;
     }
 
-    map_remove(m, size, key);
+    node_remove(m, n);
+
+    incremental_advance(m);
 }
 
 void map_remove(map *m, size_t size, const void *key){
@@ -1154,34 +3036,32 @@ void map_remove(map *m, size_t size, const void *key){
         return;
     }
 
-    size_t index;
-
-    if (!get_node_index(m, &index, size, key)){
-        return;
-    }
-
-    node *n = m->nodes[index];
+    remove_node(m, generate_hash(m, size, key), size, key);
+}
 
-    if (n == m->first){
-        m->first = n->next;
-    }
-    else if (n == m->last){
-        m->last = n->prev;
-    }
+void map_remove_prehashed(map *m, map_hash hash, size_t size, const void *key){
+    if (!m){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] map_remove_prehashed() - map is NULL\n",
+            __FILE__
+        );
 
-    if (n->next){
-        n->next->prev = n->prev;
+        return;
     }
+    else if (!key){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] map_remove_prehashed() - key is NULL\n",
+            __FILE__
+        );
 
-    if (n->prev){
-        n->prev->next = n->next;
+        return;
     }
 
-    node_free(n);
-
-    m->nodes[index] = NULL;
-
-    --m->length;
+    remove_node(m, hash, size, key);
 }
 
 void map_free(map *m){
@@ -1196,18 +3076,28 @@ void map_free(map *m){
         return;
     }
 
-    for (size_t index = 0; index < m->size; ++index){
-        node *n = m->nodes[index];
-
-        if (!n){
-            /* skip empty index */
+    for (size_t index = 0; index < m->nodeslength; ++index){
+        node *n = m->nodes + index;
 
+        if (node_is_hole(n)){
             continue;
         }
 
-        node_free(n);
+        item_free(&n->key);
+        item_free(&n->value);
     }
 
     free(m->nodes);
+
+    table_free(&m->table);
+    table_free(&m->rehash);
+
+    arena_free(m->arena);
+    arena_free(m->blocks);
+
+    if (m->filter){
+        filter_free(m->filter);
+    }
+
     free(m);
 }
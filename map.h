@@ -9,6 +9,9 @@
 
 typedef struct list list;
 typedef struct node node;
+typedef struct map_arena map_arena;
+typedef struct atom atom;
+typedef struct filter filter;
 
 typedef enum {
     M_TYPE_BOOL,
@@ -27,38 +30,220 @@ typedef enum {
     M_TYPE_RESERVED_EMPTY
 } mtype;
 
+typedef enum {
+    M_PROBE_GROUP,
+    M_PROBE_ROBIN_HOOD
+} mprobe;
+
+typedef enum {
+    M_RESIZE_SYNC,
+    M_RESIZE_INCREMENTAL
+} mresize;
+
+typedef enum {
+    M_STATUS_OK,
+    M_STATUS_NOT_FOUND,
+    M_STATUS_TYPE_MISMATCH,
+    M_STATUS_INVALID
+} mstatus;
+
+typedef uint64_t map_hash;
+
 typedef void (*map_generic_free)(void *);
+typedef uint64_t (*map_hasher)(const void *, size_t, uint64_t);
+
+/*
+ * copied bool, char, double, int, uint and size_t values are stored in
+ * the item itself instead of being allocated, strings never are
+ */
+typedef union map_inline {
+    bool b;
+    char c;
+    double d;
+    int64_t i;
+    uint64_t u;
+    size_t z;
+} map_inline;
 
 typedef struct map_item {
     mtype type;
+
+    /*
+     * only set by the map on items it stores, ignored on items passed
+     * in. an inlined item keeps its payload in local and data is NULL,
+     * so read stored items through map_item_get_data
+     */
+    bool inlined;
+
     size_t size;
     void *data;
     const void *data_copy;
     map_generic_free generic_free;
+
+    map_inline local;
 } map_item;
 
+typedef struct map_options {
+    mprobe probe;
+    mresize resize;
+
+    /* NULL selects map_hash_spooky */
+    map_hasher hasher;
+
+    /* copied keys and values are bump allocated, see map_init_arena */
+    bool arena;
+
+    /*
+     * keys are interned (atom.h) instead of copied and hashed like
+     * atoms, so an atom's hash is its map_hash -- overrides hasher.
+     * keys the bounded atom table turns away are copied as usual
+     */
+    bool atoms;
+
+    /*
+     * expected number of keys for a bloom filter (filter.h) in front
+     * of the table, 0 for none. lookups of absent keys mostly stop at
+     * the filter. it is rebuilt larger once the map outgrows it.
+     * pays off most with M_PROBE_ROBIN_HOOD -- the control bytes of
+     * M_PROBE_GROUP already turn most misses away
+     */
+    size_t filter;
+} map_options;
+
+/* index into the nodes array -- slots hold node positions */
+typedef struct map_table {
+    int8_t *ctrl;
+    uint32_t *slots;
+    size_t size;
+    size_t deleted;
+} map_table;
+
 typedef struct map {
-    uint32_t seed;
+    uint64_t seed;
+    map_hasher hasher;
+    mprobe probe;
+    mresize resize;
+    bool atoms;
+
+    map_table table;
+
+    /* old table while an incremental resize is in progress */
+    map_table rehash;
+    size_t rehashindex;
+
+    /* insertion ordered, removed nodes stay as holes until compacted */
+    node *nodes;
+    size_t nodeslength;
+    size_t nodessize;
+
+    /*
+     * incremental compaction, M_RESIZE_INCREMENTAL only. nodes below
+     * compactwrite are packed, the ones from there up to compactread
+     * are holes it left behind
+     */
+    bool compacting;
+    size_t compactread;
+    size_t compactwrite;
 
-    node **nodes;
     size_t length;
-    size_t size;
 
-    node *first;
-    node *last;
+    /* table rebuilds and incremental resizes started, see map_stats */
+    size_t resizes;
+
+    /* lookups, only counted when built with MAP_STATS_COUNTERS */
+    uint64_t hits;
+    uint64_t misses;
+
+    /* NULL unless the map was created in arena mode */
+    map_arena *arena;
+
+    /* key copies made in one block by map_set_many, freed by map_free */
+    map_arena *blocks;
+
+    /* NULL unless map_options.filter was set */
+    filter *filter;
 } map;
 
+/* probe lengths of MAP_STATS_PROBES - 1 and above share the last bucket */
+#define MAP_STATS_PROBES 16
+
+typedef struct mstats {
+    size_t length;
+    size_t slots;
+    double load;
+
+    /* deleted control bytes and removed nodes not compacted yet */
+    size_t tombstones;
+    size_t holes;
+
+    size_t resizes;
+    bool rehashing;
+
+    /*
+     * per entry, how far it sits from its home -- in groups for
+     * M_PROBE_GROUP and in slots for M_PROBE_ROBIN_HOOD
+     */
+    size_t probes[MAP_STATS_PROBES];
+    size_t maxprobe;
+    double meanprobe;
+
+    /* slots is the index (control bytes and slots) of both tables */
+    size_t slotbytes;
+    size_t nodebytes;
+    size_t keybytes;
+    size_t valuebytes;
+    size_t filterbytes;
+
+    /* zero unless built with MAP_STATS_COUNTERS */
+    uint64_t hits;
+    uint64_t misses;
+} mstats;
+
 typedef struct mapiter {
     const map *m;
     const node *n;
 } mapiter;
 
+/*
+ * hashers for map_options. the full 64-bit hash is kept per
+ * entry so keys are never rehashed on resize. wyhash is the
+ * cheapest on short keys (16 bytes or less)
+ */
+uint64_t map_hash_spooky(const void *, size_t, uint64_t);
+uint64_t map_hash_murmur3(const void *, size_t, uint64_t);
+uint64_t map_hash_wyhash(const void *, size_t, uint64_t);
+
 map *map_init(void);
+map *map_init_ex(const map_options *);
+
+/*
+ * copied keys and string/scalar values come from blocks owned by the
+ * map and are released all at once by map_free. memory of overwritten
+ * or removed entries is only reclaimed then -- meant for short-lived
+ * maps that are filled once
+ */
+map *map_init_arena(void);
 map *map_copy(const map *);
 bool map_resize(map *, size_t);
 
+/*
+ * sizes the index and node array for n entries in one go (also
+ * finishing a pending incremental resize), so filling the map up to n
+ * does no further resizes
+ */
+bool map_reserve(map *, size_t);
+
+/*
+ * incremental resizes advance on map_set/map_remove/map_pop.
+ * this moves up to n more old slots -- for idle time
+ */
+bool map_rehash_step(map *, size_t);
+
 size_t map_get_length(const map *);
 size_t map_get_size(const map *);
+
+/* walks the whole index -- O(size), meant for diagnostics */
+bool map_stats(const map *, mstats *);
 /* const char *map_to_string(const map *); */
 
 mapiter *map_iter_init(const map *);
@@ -69,6 +254,20 @@ bool map_iter_next(mapiter *);
 bool map_iter_prev(mapiter *);
 void map_iter_free(mapiter *);
 
+/*
+ * silent lookups -- nothing is logged so misses stay cheap. the stored
+ * value is written to the out pointer on M_STATUS_OK and on
+ * M_STATUS_TYPE_MISMATCH (M_TYPE_RESERVED_EMPTY matches any type). it
+ * is only valid until the map is next modified. the out pointer may be
+ * NULL. read its payload with map_item_get_data, scalars are stored
+ * inline
+ */
+mstatus map_try_get(const map *, size_t, const void *, mtype, const map_item **);
+mstatus map_try_get_prehashed(const map *, map_hash, size_t, const void *, mtype, const map_item **);
+
+/* data, or the inline payload of a stored scalar */
+const void *map_item_get_data(const map_item *);
+
 bool map_contains(const map *, size_t, const void *);
 mtype map_get_type(const map *, size_t, const void *);
 bool map_get_bool(const map *, size_t, const void *);
@@ -90,10 +289,77 @@ list *map_get_list(const map *, size_t, const void *);
 map *map_get_map(const map *, size_t, const void *);
 void *map_get_generic(const map *, size_t, const void *);
 
+/*
+ * prehashed lookups. a map_hash from map_hash_key is only valid
+ * for the map it came from (and copies of it) -- it depends on the
+ * map's seed and hasher
+ */
+map_hash map_hash_key(const map *, size_t, const void *);
+
+bool map_contains_prehashed(const map *, map_hash, size_t, const void *);
+mtype map_get_prehashed_type(const map *, map_hash, size_t, const void *);
+bool map_get_prehashed_bool(const map *, map_hash, size_t, const void *);
+char map_get_prehashed_char(const map *, map_hash, size_t, const void *);
+double map_get_prehashed_double(const map *, map_hash, size_t, const void *);
+int64_t map_get_prehashed_int(const map *, map_hash, size_t, const void *);
+uint64_t map_get_prehashed_uint(const map *, map_hash, size_t, const void *);
+size_t map_get_prehashed_size_t(const map *, map_hash, size_t, const void *);
+
+/* same warning as above */
+char *map_get_prehashed_string(const map *, map_hash, size_t, const void *);
+list *map_get_prehashed_list(const map *, map_hash, size_t, const void *);
+map *map_get_prehashed_map(const map *, map_hash, size_t, const void *);
+void *map_get_prehashed_generic(const map *, map_hash, size_t, const void *);
+
+/*
+ * looks up count keys at once, hashing and prefetching them in batches
+ * so the memory loads overlap. each value is set like map_iter_get_value
+ * would or gets type M_TYPE_RESERVED_ERROR when the key is missing or
+ * NULL. returns how many keys were found
+ */
+size_t map_get_many(const map *, size_t, const void *const *, const size_t *, map_item *);
+
 bool map_set(map *, const map_item *, const map_item *);
 
+/*
+ * map_set/map_pop/map_remove with a hash from map_hash_key, for callers
+ * that already hashed the key. map_set_prehashed refuses atom keyed maps
+ */
+bool map_set_prehashed(map *, map_hash, const map_item *, const map_item *);
+
+/*
+ * sets count keys (same rules as map_set) after reserving room for all
+ * of them. the keys are hashed up front and new ones are copied into a
+ * single block, which is only released by map_free. returns how many
+ * were set -- on failure values from that index on were not taken over
+ */
+size_t map_set_many(map *, size_t, const map_item *, const map_item *);
+
+/*
+ * map_init_ex (options may be NULL) followed by map_set_many. values
+ * handed over in data are taken over even when this fails
+ */
+map *map_from_arrays(const map_options *, size_t, const map_item *, const map_item *);
+
+/*
+ * the key is taken from key->data and only the pointer is stored. it
+ * must stay valid and unchanged until it is removed or the map is freed
+ * -- string keys are used as is, without a copied terminator. copies of
+ * the map get their own copies of the keys
+ */
+bool map_set_borrowed(map *, const map_item *, const map_item *);
+
+/*
+ * atom keyed maps only. the key is a string key. to look one up
+ * without hashing use the prehashed getters with a->hash, a->size
+ * and a->string -- the key then matches by pointer
+ */
+bool map_set_atom(map *, const atom *, const map_item *);
+
 void map_pop(map *, size_t, const void *, map_item *);
 void map_remove(map *, size_t, const void *);
+void map_pop_prehashed(map *, map_hash, size_t, const void *, map_item *);
+void map_remove_prehashed(map *, map_hash, size_t, const void *);
 void map_free(map *);
 
 #endif
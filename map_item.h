@@ -0,0 +1,18 @@
+#ifndef MAP_ITEM_H
+#define MAP_ITEM_H
+
+#include "map.h"
+
+#include <stdbool.h>
+
+/*
+ * internal -- for the modules that keep map_items outside a map (cache,
+ * imap, omap, pmap). the copy takes over value->data and copies
+ * value->data_copy. it is never inlined, so data can be read directly
+ */
+bool map_item_init(map_item *, const map_item *);
+
+/* frees what the item owns, not the item itself */
+void map_item_free(map_item *);
+
+#endif
@@ -0,0 +1,1070 @@
+#include "omap.h"
+
+#include "log.h"
+#include "map_item.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define OMAP_CACHE_LINE 64
+
+static logctx *logger = NULL;
+
+/*
+ * a node holds up to OMAP_ORDER - 1 keys, the last key slot is only
+ * used for the moment between an insert and the split it triggers.
+ * inner nodes keep count + 1 children, keys[i] is the smallest key
+ * children[i + 1] had when it was split off
+ */
+typedef struct omap_node {
+    bool leaf;
+    uint32_t count;
+
+    map_item keys[OMAP_ORDER];
+
+    union {
+        struct omap_node *children[OMAP_ORDER + 1];
+
+        struct {
+            map_item values[OMAP_ORDER];
+            struct omap_node *prev;
+            struct omap_node *next;
+        };
+    };
+} omap_node;
+
+static omap_node *node_alloc(bool leaf){
+    size_t size = (sizeof(omap_node) + OMAP_CACHE_LINE - 1) & ~(size_t)(OMAP_CACHE_LINE - 1);
+    omap_node *n = aligned_alloc(OMAP_CACHE_LINE, size);
+
+    if (!n){
+        log_write(
+            logger,
+            LOG_ERROR,
+            "[%s] node_alloc() - node alloc failed\n",
+            __FILE__
+        );
+
+        return NULL;
+    }
+
+    memset(n, 0, sizeof(*n));
+
+    n->leaf = leaf;
+
+    return n;
+}
+
+/* keys are always copied as raw bytes */
+static bool key_init(map_item *i, const map_item *key){
+    i->type = key->type;
+    i->size = key->size;
+    i->data = malloc(key->size + 1);
+    i->data_copy = NULL;
+    i->generic_free = NULL;
+
+    if (!i->data){
+        log_write(
+            logger,
+            LOG_ERROR,
+            "[%s] key_init() - key alloc failed\n",
+            __FILE__
+        );
+
+        return false;
+    }
+
+    memcpy(i->data, key->data ? key->data : key->data_copy, key->size);
+
+    ((char *)i->data)[key->size] = '\0';
+
+    return true;
+}
+
+static void node_free(omap_node *n){
+    for (uint32_t index = 0; index < n->count; ++index){
+        free(n->keys[index].data);
+
+        if (n->leaf){
+            map_item_free(n->values + index);
+        }
+    }
+
+    if (!n->leaf){
+        for (uint32_t index = 0; index <= n->count; ++index){
+            node_free(n->children[index]);
+        }
+    }
+
+    free(n);
+}
+
+/* first index whose key is >= key */
+static size_t lower_bound(const omap *o, const omap_node *n, size_t size, const void *key){
+    size_t low = 0;
+    size_t high = n->count;
+
+    while (low < high){
+        size_t mid = (low + high) / 2;
+
+        if (o->compare(n->keys[mid].data, n->keys[mid].size, key, size) < 0){
+            low = mid + 1;
+        }
+        else {
+            high = mid;
+        }
+    }
+
+    return low;
+}
+
+/* first index whose key is > key -- the child that can hold key */
+static size_t upper_bound(const omap *o, const omap_node *n, size_t size, const void *key){
+    size_t low = 0;
+    size_t high = n->count;
+
+    while (low < high){
+        size_t mid = (low + high) / 2;
+
+        if (o->compare(n->keys[mid].data, n->keys[mid].size, key, size) <= 0){
+            low = mid + 1;
+        }
+        else {
+            high = mid;
+        }
+    }
+
+    return low;
+}
+
+/* path and indexes get the inner nodes passed and the child taken in each */
+static omap_node *descend(const omap *o, size_t size, const void *key, omap_node **path, size_t *indexes, size_t *depth){
+    omap_node *n = o->root;
+    size_t level = 0;
+
+    while (!n->leaf){
+        size_t index = upper_bound(o, n, size, key);
+
+        if (path){
+            path[level] = n;
+            indexes[level] = index;
+        }
+
+        ++level;
+
+        n = n->children[index];
+    }
+
+    if (depth){
+        *depth = level;
+    }
+
+    return n;
+}
+
+static bool find_entry(const omap *o, size_t size, const void *key, const omap_node **leaf, size_t *index){
+    const omap_node *n = descend(o, size, key, NULL, NULL, NULL);
+    size_t position = lower_bound(o, n, size, key);
+
+    if (position == n->count || o->compare(n->keys[position].data, n->keys[position].size, key, size)){
+        return false;
+    }
+
+    *leaf = n;
+    *index = position;
+
+    return true;
+}
+
+static const map_item *get_value(const omap *o, size_t size, const void *key, mtype type){
+    if (!o){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] get_value() - omap is NULL\n",
+            __FILE__
+        );
+
+        return NULL;
+    }
+    else if (!key){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] get_value() - key is NULL\n",
+            __FILE__
+        );
+
+        return NULL;
+    }
+
+    const omap_node *leaf;
+    size_t index;
+
+    if (!find_entry(o, size, key, &leaf, &index)){
+        log_write(
+            logger,
+            LOG_DEBUG,
+            "[%s] get_value() - key does not exist\n",
+            __FILE__
+        );
+
+        return NULL;
+    }
+
+    const map_item *value = leaf->values + index;
+
+    if (type != M_TYPE_RESERVED_EMPTY && value->type != type){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] get_value() - value type does *not* match\n",
+            __FILE__
+        );
+    }
+
+    return value;
+}
+
+/*
+ * moves the upper half of a full node into right. for leaves the
+ * separator is a copy of right's first key, for inner nodes the middle
+ * key moves up
+ */
+static void split_leaf(omap_node *leaf, omap_node *right){
+    uint32_t half = leaf->count / 2;
+
+    right->count = leaf->count - half;
+
+    memcpy(right->keys, leaf->keys + half, right->count * sizeof(*right->keys));
+    memcpy(right->values, leaf->values + half, right->count * sizeof(*right->values));
+
+    leaf->count = half;
+
+    right->prev = leaf;
+    right->next = leaf->next;
+
+    if (leaf->next){
+        leaf->next->prev = right;
+    }
+
+    leaf->next = right;
+}
+
+static void split_inner(omap_node *n, omap_node *right, map_item *separator){
+    uint32_t mid = n->count / 2;
+
+    *separator = n->keys[mid];
+
+    right->count = n->count - mid - 1;
+
+    memcpy(right->keys, n->keys + mid + 1, right->count * sizeof(*right->keys));
+    memcpy(right->children, n->children + mid + 1, (right->count + 1) * sizeof(*right->children));
+
+    n->count = mid;
+}
+
+static void insert_child(omap_node *n, size_t index, const map_item *separator, omap_node *child){
+    memmove(n->keys + index + 1, n->keys + index, (n->count - index) * sizeof(*n->keys));
+    memmove(n->children + index + 2, n->children + index + 1, (n->count - index) * sizeof(*n->children));
+
+    n->keys[index] = *separator;
+    n->children[index + 1] = child;
+
+    ++n->count;
+}
+
+static void remove_child(omap_node *n, size_t index){
+    size_t key = index ? index - 1 : 0;
+
+    free(n->keys[key].data);
+
+    memmove(n->keys + key, n->keys + key + 1, (n->count - key - 1) * sizeof(*n->keys));
+    memmove(n->children + index, n->children + index + 1, (n->count - index) * sizeof(*n->children));
+
+    --n->count;
+}
+
+static omapiter *iter_init(const omap *o, const omap_node *leaf, size_t index, omap_bound kind, size_t size, const void *bound){
+    omapiter *iter = malloc(sizeof(*iter) + size);
+
+    if (!iter){
+        log_write(
+            logger,
+            LOG_ERROR,
+            "[%s] iter_init() - iterator alloc failed\n",
+            __FILE__
+        );
+
+        return NULL;
+    }
+
+    iter->o = o;
+    iter->leaf = leaf;
+    iter->index = index;
+    iter->started = false;
+    iter->kind = kind;
+    iter->boundsize = size;
+
+    if (size){
+        memcpy(iter->bound, bound, size);
+    }
+
+    return iter;
+}
+
+static omapiter *iter_seek(const omap *o, size_t size, const void *key, omap_bound kind, size_t boundsize, const void *bound){
+    const omap_node *leaf = descend(o, size, key, NULL, NULL, NULL);
+
+    return iter_init(o, leaf, lower_bound(o, leaf, size, key), kind, boundsize, bound);
+}
+
+int omap_compare_bytes(const void *a, size_t asize, const void *b, size_t bsize){
+    int result = memcmp(a, b, asize < bsize ? asize : bsize);
+
+    if (result){
+        return result;
+    }
+
+    return (asize > bsize) - (asize < bsize);
+}
+
+int omap_compare_int(const void *a, size_t asize, const void *b, size_t bsize){
+    if (asize != sizeof(int64_t) || bsize != sizeof(int64_t)){
+        return omap_compare_bytes(a, asize, b, bsize);
+    }
+
+    int64_t x, y;
+
+    memcpy(&x, a, sizeof(x));
+    memcpy(&y, b, sizeof(y));
+
+    return (x > y) - (x < y);
+}
+
+int omap_compare_uint(const void *a, size_t asize, const void *b, size_t bsize){
+    if (asize != sizeof(uint64_t) || bsize != sizeof(uint64_t)){
+        return omap_compare_bytes(a, asize, b, bsize);
+    }
+
+    uint64_t x, y;
+
+    memcpy(&x, a, sizeof(x));
+    memcpy(&y, b, sizeof(y));
+
+    return (x > y) - (x < y);
+}
+
+int omap_compare_double(const void *a, size_t asize, const void *b, size_t bsize){
+    if (asize != sizeof(double) || bsize != sizeof(double)){
+        return omap_compare_bytes(a, asize, b, bsize);
+    }
+
+    double x, y;
+
+    memcpy(&x, a, sizeof(x));
+    memcpy(&y, b, sizeof(y));
+
+    return (x > y) - (x < y);
+}
+
+omap *omap_init(void){
+    return omap_init_ex(NULL);
+}
+
+omap *omap_init_ex(const omap_options *options){
+    omap *o = malloc(sizeof(*o));
+
+    if (!o){
+        log_write(
+            logger,
+            LOG_ERROR,
+            "[%s] omap_init_ex() - omap alloc failed\n",
+            __FILE__
+        );
+
+        return NULL;
+    }
+
+    o->root = node_alloc(true);
+
+    if (!o->root){
+        log_write(
+            logger,
+            LOG_ERROR,
+            "[%s] omap_init_ex() - root initialization failed\n",
+            __FILE__
+        );
+
+        free(o);
+
+        return NULL;
+    }
+
+    o->first = o->root;
+    o->length = 0;
+    o->compare = options && options->compare ? options->compare : omap_compare_bytes;
+
+    return o;
+}
+
+size_t omap_get_length(const omap *o){
+    if (!o){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] omap_get_length() - omap is NULL\n",
+            __FILE__
+        );
+
+        return 0;
+    }
+
+    return o->length;
+}
+
+omapiter *omap_iter_init(const omap *o){
+    if (!o){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] omap_iter_init() - omap is NULL\n",
+            __FILE__
+        );
+
+        return NULL;
+    }
+
+    return iter_init(o, o->first, 0, OMAP_BOUND_NONE, 0, NULL);
+}
+
+omapiter *omap_lower_bound(const omap *o, size_t size, const void *key){
+    if (!o || !key){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] omap_lower_bound() - omap or key is NULL\n",
+            __FILE__
+        );
+
+        return NULL;
+    }
+
+    return iter_seek(o, size, key, OMAP_BOUND_NONE, 0, NULL);
+}
+
+omapiter *omap_range(const omap *o, size_t startsize, const void *start, size_t endsize, const void *end){
+    if (!o || !start || !end){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] omap_range() - omap, start or end is NULL\n",
+            __FILE__
+        );
+
+        return NULL;
+    }
+
+    return iter_seek(o, startsize, start, OMAP_BOUND_BELOW, endsize, end);
+}
+
+omapiter *omap_prefix(const omap *o, size_t size, const void *prefix){
+    if (!o || !prefix){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] omap_prefix() - omap or prefix is NULL\n",
+            __FILE__
+        );
+
+        return NULL;
+    }
+
+    return iter_seek(o, size, prefix, OMAP_BOUND_PREFIX, size, prefix);
+}
+
+bool omap_iter_get_key(const omapiter *iter, map_item *key){
+    if (!iter || !key){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] omap_iter_get_key() - iterator or key is NULL\n",
+            __FILE__
+        );
+
+        return false;
+    }
+    else if (!iter->started || !iter->leaf){
+        log_write(
+            logger,
+            LOG_DEBUG,
+            "[%s] omap_iter_get_key() - omap_iter_next hasn't been called or the range is done\n",
+            __FILE__
+        );
+
+        return false;
+    }
+
+    *key = iter->leaf->keys[iter->index];
+
+    return true;
+}
+
+bool omap_iter_get_value(const omapiter *iter, map_item *value){
+    if (!iter || !value){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] omap_iter_get_value() - iterator or value is NULL\n",
+            __FILE__
+        );
+
+        return false;
+    }
+    else if (!iter->started || !iter->leaf){
+        log_write(
+            logger,
+            LOG_DEBUG,
+            "[%s] omap_iter_get_value() - omap_iter_next hasn't been called or the range is done\n",
+            __FILE__
+        );
+
+        return false;
+    }
+
+    *value = iter->leaf->values[iter->index];
+
+    return true;
+}
+
+bool omap_iter_next(omapiter *iter){
+    if (!iter){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] omap_iter_next() - iterator is NULL\n",
+            __FILE__
+        );
+
+        return false;
+    }
+
+    if (!iter->leaf){
+        return false;
+    }
+
+    if (iter->started){
+        ++iter->index;
+    }
+
+    iter->started = true;
+
+    while (iter->leaf && iter->index >= iter->leaf->count){
+        iter->leaf = iter->leaf->next;
+        iter->index = 0;
+    }
+
+    if (!iter->leaf){
+        return false;
+    }
+
+    const map_item *key = iter->leaf->keys + iter->index;
+    bool inside = true;
+
+    if (iter->kind == OMAP_BOUND_BELOW){
+        inside = iter->o->compare(key->data, key->size, iter->bound, iter->boundsize) < 0;
+    }
+    else if (iter->kind == OMAP_BOUND_PREFIX){
+        inside = key->size >= iter->boundsize && !memcmp(key->data, iter->bound, iter->boundsize);
+    }
+
+    if (!inside){
+        iter->leaf = NULL;
+    }
+
+    return inside;
+}
+
+void omap_iter_free(omapiter *iter){
+    free(iter);
+}
+
+mstatus omap_try_get(const omap *o, size_t size, const void *key, mtype type, const map_item **value){
+    if (value){
+        *value = NULL;
+    }
+
+    if (!o || !key){
+        return M_STATUS_INVALID;
+    }
+
+    const omap_node *leaf;
+    size_t index;
+
+    if (!find_entry(o, size, key, &leaf, &index)){
+        return M_STATUS_NOT_FOUND;
+    }
+
+    if (value){
+        *value = leaf->values + index;
+    }
+
+    if (type != M_TYPE_RESERVED_EMPTY && leaf->values[index].type != type){
+        return M_STATUS_TYPE_MISMATCH;
+    }
+
+    return M_STATUS_OK;
+}
+
+bool omap_contains(const omap *o, size_t size, const void *key){
+    if (!o || !key){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] omap_contains() - omap or key is NULL\n",
+            __FILE__
+        );
+
+        return false;
+    }
+
+    const omap_node *leaf;
+    size_t index;
+
+    return find_entry(o, size, key, &leaf, &index);
+}
+
+mtype omap_get_type(const omap *o, size_t size, const void *key){
+    const map_item *value = get_value(o, size, key, M_TYPE_RESERVED_EMPTY);
+
+    if (!value){
+        return M_TYPE_RESERVED_ERROR;
+    }
+
+    return value->type;
+}
+
+bool omap_get_bool(const omap *o, size_t size, const void *key){
+    const map_item *value = get_value(o, size, key, M_TYPE_BOOL);
+
+    if (!value){
+        return false;
+    }
+
+    return *(bool *)value->data;
+}
+
+char omap_get_char(const omap *o, size_t size, const void *key){
+    const map_item *value = get_value(o, size, key, M_TYPE_CHAR);
+
+    if (!value){
+        return 0;
+    }
+
+    return *(char *)value->data;
+}
+
+double omap_get_double(const omap *o, size_t size, const void *key){
+    const map_item *value = get_value(o, size, key, M_TYPE_DOUBLE);
+
+    if (!value){
+        return 0.0;
+    }
+
+    return *(double *)value->data;
+}
+
+int64_t omap_get_int(const omap *o, size_t size, const void *key){
+    const map_item *value = get_value(o, size, key, M_TYPE_INT);
+
+    if (!value){
+        return 0;
+    }
+
+    return *(int64_t *)value->data;
+}
+
+uint64_t omap_get_uint(const omap *o, size_t size, const void *key){
+    const map_item *value = get_value(o, size, key, M_TYPE_UINT);
+
+    if (!value){
+        return 0;
+    }
+
+    return *(uint64_t *)value->data;
+}
+
+size_t omap_get_size_t(const omap *o, size_t size, const void *key){
+    const map_item *value = get_value(o, size, key, M_TYPE_SIZE_T);
+
+    if (!value){
+        return 0;
+    }
+
+    return *(size_t *)value->data;
+}
+
+/*
+ * READ WARNING FOR THESE FUNCTIONS IN HEADER FILE
+ */
+char *omap_get_string(const omap *o, size_t size, const void *key){
+    const map_item *value = get_value(o, size, key, M_TYPE_STRING);
+
+    if (!value){
+        return NULL;
+    }
+
+    return value->data;
+}
+
+list *omap_get_list(const omap *o, size_t size, const void *key){
+    const map_item *value = get_value(o, size, key, M_TYPE_LIST);
+
+    if (!value){
+        return NULL;
+    }
+
+    return value->data;
+}
+
+map *omap_get_map(const omap *o, size_t size, const void *key){
+    const map_item *value = get_value(o, size, key, M_TYPE_MAP);
+
+    if (!value){
+        return NULL;
+    }
+
+    return value->data;
+}
+
+void *omap_get_generic(const omap *o, size_t size, const void *key){
+    const map_item *value = get_value(o, size, key, M_TYPE_GENERIC);
+
+    if (!value){
+        return NULL;
+    }
+
+    return value->data;
+}
+
+bool omap_set(omap *o, const map_item *key, const map_item *value){
+    if (!o){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] omap_set() - omap is NULL\n",
+            __FILE__
+        );
+
+        return false;
+    }
+    else if (!key || !value){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] omap_set() - key or value is NULL\n",
+            __FILE__
+        );
+
+        return false;
+    }
+    else if (key->data){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] omap_set() - key will *always* be copied -- set key in data_copy instead\n",
+            __FILE__
+        );
+
+        return false;
+    }
+
+    omap_node *path[OMAP_MAX_DEPTH];
+    size_t indexes[OMAP_MAX_DEPTH];
+    size_t depth;
+
+    omap_node *leaf = descend(o, key->size, key->data_copy, path, indexes, &depth);
+    size_t index = lower_bound(o, leaf, key->size, key->data_copy);
+
+    if (index < leaf->count && !o->compare(leaf->keys[index].data, leaf->keys[index].size, key->data_copy, key->size)){
+        map_item tmp;
+
+        if (!map_item_init(&tmp, value)){
+            log_write(
+                logger,
+                LOG_ERROR,
+                "[%s] omap_set() - value initialization failed\n",
+                __FILE__
+            );
+
+            return false;
+        }
+
+        map_item_free(leaf->values + index);
+
+        leaf->values[index] = tmp;
+
+        return true;
+    }
+
+    /* every node that splits, plus a new root if the root does -- allocated up front so a split can't fail halfway */
+    omap_node *spares[OMAP_MAX_DEPTH + 1];
+    size_t needed = 0;
+
+    if (leaf->count == OMAP_ORDER - 1){
+        ++needed;
+
+        for (size_t level = depth; level > 0 && path[level - 1]->count == OMAP_ORDER - 1; --level){
+            ++needed;
+        }
+
+        if (needed == depth + 1){
+            if (depth + 1 >= OMAP_MAX_DEPTH){
+                log_write(
+                    logger,
+                    LOG_ERROR,
+                    "[%s] omap_set() - OMAP_MAX_DEPTH reached\n",
+                    __FILE__
+                );
+
+                return false;
+            }
+
+            ++needed;
+        }
+    }
+
+    for (size_t spare = 0; spare < needed; ++spare){
+        spares[spare] = node_alloc(spare == 0);
+
+        if (!spares[spare]){
+            log_write(
+                logger,
+                LOG_ERROR,
+                "[%s] omap_set() - node_alloc call failed\n",
+                __FILE__
+            );
+
+            while (spare){
+                free(spares[--spare]);
+            }
+
+            return false;
+        }
+    }
+
+    map_item k, v;
+    map_item separator = {0};
+
+    bool initialized = key_init(&k, key);
+
+    if (initialized && !map_item_init(&v, value)){
+        free(k.data);
+
+        initialized = false;
+    }
+
+    /* the separator a leaf split pushes up is right's first key */
+    if (initialized && needed){
+        const map_item *first = index == OMAP_ORDER / 2 ? &k : leaf->keys + OMAP_ORDER / 2 - (index < OMAP_ORDER / 2);
+
+        if (!key_init(&separator, first)){
+            free(k.data);
+
+            if (!value->data){
+                map_item_free(&v);
+            }
+
+            initialized = false;
+        }
+    }
+
+    if (!initialized){
+        log_write(
+            logger,
+            LOG_ERROR,
+            "[%s] omap_set() - item initialization failed\n",
+            __FILE__
+        );
+
+        for (size_t spare = 0; spare < needed; ++spare){
+            free(spares[spare]);
+        }
+
+        return false;
+    }
+
+    memmove(leaf->keys + index + 1, leaf->keys + index, (leaf->count - index) * sizeof(*leaf->keys));
+    memmove(leaf->values + index + 1, leaf->values + index, (leaf->count - index) * sizeof(*leaf->values));
+
+    leaf->keys[index] = k;
+    leaf->values[index] = v;
+
+    ++leaf->count;
+    ++o->length;
+
+    if (!needed){
+        return true;
+    }
+
+    omap_node *child = leaf;
+    omap_node *sibling = spares[0];
+
+    split_leaf(leaf, sibling);
+
+    for (size_t level = depth, spare = 1; ; --level){
+        if (!level){
+            omap_node *root = spares[spare];
+
+            root->count = 1;
+            root->keys[0] = separator;
+            root->children[0] = child;
+            root->children[1] = sibling;
+
+            o->root = root;
+
+            break;
+        }
+
+        omap_node *parent = path[level - 1];
+
+        insert_child(parent, indexes[level - 1], &separator, sibling);
+
+        if (parent->count < OMAP_ORDER){
+            break;
+        }
+
+        child = parent;
+        sibling = spares[spare++];
+
+        split_inner(parent, sibling, &separator);
+    }
+
+    return true;
+}
+
+void omap_remove(omap *o, size_t size, const void *key){
+    if (!o){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] omap_remove() - omap is NULL\n",
+            __FILE__
+        );
+
+        return;
+    }
+    else if (!key){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] omap_remove() - key is NULL\n",
+            __FILE__
+        );
+
+        return;
+    }
+
+    omap_node *path[OMAP_MAX_DEPTH];
+    size_t indexes[OMAP_MAX_DEPTH];
+    size_t depth;
+
+    omap_node *leaf = descend(o, size, key, path, indexes, &depth);
+    size_t index = lower_bound(o, leaf, size, key);
+
+    if (index == leaf->count || o->compare(leaf->keys[index].data, leaf->keys[index].size, key, size)){
+        log_write(
+            logger,
+            LOG_DEBUG,
+            "[%s] omap_remove() - key does not exist\n",
+            __FILE__
+        );
+
+        return;
+    }
+
+    free(leaf->keys[index].data);
+    map_item_free(leaf->values + index);
+
+    memmove(leaf->keys + index, leaf->keys + index + 1, (leaf->count - index - 1) * sizeof(*leaf->keys));
+    memmove(leaf->values + index, leaf->values + index + 1, (leaf->count - index - 1) * sizeof(*leaf->values));
+
+    --leaf->count;
+    --o->length;
+
+    if (leaf->count || !depth){
+        return;
+    }
+
+    if (!o->length){
+        /* only this leaf is left under the path -- it becomes the root */
+        for (size_t level = 0; level < depth; ++level){
+            for (uint32_t separator = 0; separator < path[level]->count; ++separator){
+                free(path[level]->keys[separator].data);
+            }
+
+            free(path[level]);
+        }
+
+        leaf->prev = NULL;
+        leaf->next = NULL;
+
+        o->root = leaf;
+        o->first = leaf;
+
+        return;
+    }
+
+    /* unlink the empty leaf, then drop every ancestor it leaves childless */
+    if (leaf->prev){
+        leaf->prev->next = leaf->next;
+    }
+    else {
+        o->first = leaf->next;
+    }
+
+    if (leaf->next){
+        leaf->next->prev = leaf->prev;
+    }
+
+    omap_node *gone = leaf;
+
+    for (size_t level = depth; level > 0; --level){
+        omap_node *parent = path[level - 1];
+
+        free(gone);
+
+        if (parent->count){
+            remove_child(parent, indexes[level - 1]);
+
+            break;
+        }
+
+        gone = parent;
+    }
+
+    while (!o->root->leaf && !o->root->count){
+        omap_node *root = o->root;
+
+        o->root = root->children[0];
+
+        free(root);
+    }
+}
+
+void omap_free(omap *o){
+    if (!o){
+        log_write(
+            logger,
+            LOG_DEBUG,
+            "[%s] omap_free() - omap is NULL\n",
+            __FILE__
+        );
+
+        return;
+    }
+
+    node_free(o->root);
+    free(o);
+}
@@ -0,0 +1,116 @@
+#ifndef OMAP_H
+#define OMAP_H
+
+#include "map.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * ordered map -- a B+tree with the same map_item model as map. keys
+ * are kept sorted by a comparator (byte order by default), values
+ * only live in the leaves and the leaves are linked so range scans
+ * walk them in order. keys and values are stored apart so a search
+ * only touches the key arrays. removal doesn't rebalance, a node only
+ * goes away once it is empty
+ */
+
+/* keys per node */
+#define OMAP_ORDER 16
+#define OMAP_MAX_DEPTH 24
+
+/* compares two keys (size, data) like memcmp */
+typedef int (*omap_comparator)(const void *, size_t, const void *, size_t);
+
+typedef struct omap_node omap_node;
+
+typedef struct omap_options {
+    /* NULL selects omap_compare_bytes */
+    omap_comparator compare;
+} omap_options;
+
+typedef struct omap {
+    omap_node *root;
+    omap_node *first;
+    size_t length;
+    omap_comparator compare;
+} omap;
+
+typedef enum {
+    OMAP_BOUND_NONE,
+    OMAP_BOUND_BELOW,
+    OMAP_BOUND_PREFIX
+} omap_bound;
+
+/*
+ * walks keys in order. an iterator from omap_range or omap_prefix
+ * stops at the end of its range. modifying the omap invalidates it
+ */
+typedef struct omapiter {
+    const omap *o;
+    const omap_node *leaf;
+    size_t index;
+    bool started;
+
+    /* the end key or prefix is copied into bound */
+    omap_bound kind;
+    size_t boundsize;
+    char bound[];
+} omapiter;
+
+/*
+ * comparators for omap_options. byte order is the only one prefix
+ * scans make sense for. the number ones take 8 byte keys
+ */
+int omap_compare_bytes(const void *, size_t, const void *, size_t);
+int omap_compare_int(const void *, size_t, const void *, size_t);
+int omap_compare_uint(const void *, size_t, const void *, size_t);
+int omap_compare_double(const void *, size_t, const void *, size_t);
+
+omap *omap_init(void);
+omap *omap_init_ex(const omap_options *);
+
+size_t omap_get_length(const omap *);
+
+/* every key in order */
+omapiter *omap_iter_init(const omap *);
+
+/* keys from the first one >= key to the end */
+omapiter *omap_lower_bound(const omap *, size_t, const void *);
+
+/* keys in [start, end) */
+omapiter *omap_range(const omap *, size_t, const void *, size_t, const void *);
+
+/* keys that start with the given bytes */
+omapiter *omap_prefix(const omap *, size_t, const void *);
+
+bool omap_iter_get_key(const omapiter *, map_item *);
+bool omap_iter_get_value(const omapiter *, map_item *);
+bool omap_iter_next(omapiter *);
+void omap_iter_free(omapiter *);
+
+/* silent lookup, same as map_try_get */
+mstatus omap_try_get(const omap *, size_t, const void *, mtype, const map_item **);
+
+bool omap_contains(const omap *, size_t, const void *);
+mtype omap_get_type(const omap *, size_t, const void *);
+bool omap_get_bool(const omap *, size_t, const void *);
+char omap_get_char(const omap *, size_t, const void *);
+double omap_get_double(const omap *, size_t, const void *);
+int64_t omap_get_int(const omap *, size_t, const void *);
+uint64_t omap_get_uint(const omap *, size_t, const void *);
+size_t omap_get_size_t(const omap *, size_t, const void *);
+
+/* see the warning in map.h -- the same applies here */
+char *omap_get_string(const omap *, size_t, const void *);
+list *omap_get_list(const omap *, size_t, const void *);
+map *omap_get_map(const omap *, size_t, const void *);
+void *omap_get_generic(const omap *, size_t, const void *);
+
+/* same rules as map_set -- the key is copied, value->data is taken over */
+bool omap_set(omap *, const map_item *, const map_item *);
+void omap_remove(omap *, size_t, const void *);
+void omap_free(omap *);
+
+#endif
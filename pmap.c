@@ -0,0 +1,1014 @@
+#include "pmap.h"
+
+#include "log.h"
+#include "map_item.h"
+
+#include "hashers/wyhash.h"
+
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PMAP_BITS 5
+#define PMAP_MASK ((1u << PMAP_BITS) - 1)
+#define PMAP_HASH_BITS 64
+
+static logctx *logger = NULL;
+
+typedef enum {
+    PMAP_LEAF,
+    PMAP_BRANCH,
+    PMAP_COLLISION
+} pmap_kind;
+
+/*
+ * branches keep one child per set bit in bitmap, collisions keep
+ * count leaves that share the full hash. the root is always a branch.
+ * nodes are immutable once they are reachable from a pmap
+ */
+typedef struct pmap_node {
+    pmap_kind kind;
+    atomic_size_t refs;
+
+    union {
+        struct {
+            uint64_t hash;
+            map_item key;
+            map_item value;
+        } leaf;
+
+        struct {
+            uint32_t bitmap;
+            uint32_t count;
+        } branch;
+    };
+
+    struct pmap_node *children[];
+} pmap_node;
+
+static uint64_t generate_hash(const pmap *p, size_t size, const void *key){
+    return wyhash(key, size, p->seed);
+}
+
+static uint32_t hash_bits(uint64_t hash, unsigned shift){
+    return (hash >> shift) & PMAP_MASK;
+}
+
+static uint32_t node_count(const pmap_node *n){
+    if (n->kind == PMAP_BRANCH){
+        return __builtin_popcount(n->branch.bitmap);
+    }
+
+    return n->branch.count;
+}
+
+static pmap_node *node_retain(pmap_node *n){
+    atomic_fetch_add_explicit(&n->refs, 1, memory_order_relaxed);
+
+    return n;
+}
+
+static void node_release(pmap_node *n){
+    if (!n || atomic_fetch_sub_explicit(&n->refs, 1, memory_order_acq_rel) != 1){
+        return;
+    }
+
+    if (n->kind == PMAP_LEAF){
+        map_item_free(&n->leaf.key);
+        map_item_free(&n->leaf.value);
+    }
+    else {
+        uint32_t count = node_count(n);
+
+        for (uint32_t index = 0; index < count; ++index){
+            node_release(n->children[index]);
+        }
+    }
+
+    free(n);
+}
+
+static pmap_node *node_alloc(pmap_kind kind, uint32_t count){
+    pmap_node *n = malloc(sizeof(*n) + count * sizeof(*n->children));
+
+    if (!n){
+        log_write(
+            logger,
+            LOG_ERROR,
+            "[%s] node_alloc() - node alloc failed\n",
+            __FILE__
+        );
+
+        return NULL;
+    }
+
+    n->kind = kind;
+    atomic_init(&n->refs, 1);
+
+    return n;
+}
+
+static pmap_node *leaf_init(uint64_t hash, const map_item *key, const map_item *value){
+    pmap_node *n = node_alloc(PMAP_LEAF, 0);
+
+    if (!n){
+        return NULL;
+    }
+
+    n->leaf.hash = hash;
+
+    if (!map_item_init(&n->leaf.key, key)){
+        free(n);
+
+        return NULL;
+    }
+
+    if (!map_item_init(&n->leaf.value, value)){
+        map_item_free(&n->leaf.key);
+        free(n);
+
+        return NULL;
+    }
+
+    return n;
+}
+
+static bool leaf_matches(const pmap_node *n, uint64_t hash, size_t size, const void *key){
+    return n->leaf.hash == hash && n->leaf.key.size == size && !memcmp(n->leaf.key.data, key, size);
+}
+
+/*
+ * copy of n with the child at position replaced by child (or removed
+ * when child is NULL, or inserted when insert is set). unchanged
+ * children gain a reference, child is taken over
+ */
+static pmap_node *node_with(const pmap_node *n, uint32_t bitmap, uint32_t position, pmap_node *child, bool insert){
+    uint32_t count = node_count(n);
+    uint32_t newcount = insert ? count + 1 : child ? count : count - 1;
+    pmap_node *copy = node_alloc(n->kind, newcount);
+
+    if (!copy){
+        return NULL;
+    }
+
+    copy->branch.bitmap = bitmap;
+    copy->branch.count = newcount;
+
+    uint32_t to = 0;
+
+    for (uint32_t from = 0; from < count; ++from){
+        if (from == position){
+            if (child){
+                copy->children[to++] = child;
+            }
+
+            if (!insert){
+                continue;
+            }
+        }
+
+        copy->children[to++] = node_retain(n->children[from]);
+    }
+
+    if (insert && position == count){
+        copy->children[to] = child;
+    }
+
+    return copy;
+}
+
+/* a node holding two leaves whose hashes agree below shift */
+static pmap_node *node_pair(pmap_node *a, pmap_node *b, unsigned shift){
+    if (shift >= PMAP_HASH_BITS){
+        pmap_node *n = node_alloc(PMAP_COLLISION, 2);
+
+        if (!n){
+            return NULL;
+        }
+
+        n->branch.bitmap = 0;
+        n->branch.count = 2;
+        n->children[0] = a;
+        n->children[1] = b;
+
+        return n;
+    }
+
+    uint32_t abits = hash_bits(a->leaf.hash, shift);
+    uint32_t bbits = hash_bits(b->leaf.hash, shift);
+
+    if (abits == bbits){
+        pmap_node *child = node_pair(a, b, shift + PMAP_BITS);
+
+        if (!child){
+            return NULL;
+        }
+
+        pmap_node *n = node_alloc(PMAP_BRANCH, 1);
+
+        if (!n){
+            /* give back the leaves but keep the caller's references */
+            node_retain(a);
+            node_retain(b);
+            node_release(child);
+
+            return NULL;
+        }
+
+        n->branch.bitmap = 1u << abits;
+        n->branch.count = 1;
+        n->children[0] = child;
+
+        return n;
+    }
+
+    pmap_node *n = node_alloc(PMAP_BRANCH, 2);
+
+    if (!n){
+        return NULL;
+    }
+
+    n->branch.bitmap = (1u << abits) | (1u << bbits);
+    n->branch.count = 2;
+    n->children[abits < bbits ? 0 : 1] = a;
+    n->children[abits < bbits ? 1 : 0] = b;
+
+    return n;
+}
+
+/*
+ * returns a new version of n with leaf set, n itself is left as it
+ * is. leaf is taken over on success only. *replaced tells whether the
+ * key already existed
+ */
+static pmap_node *node_set(const pmap_node *n, unsigned shift, pmap_node *leaf, bool *replaced){
+    uint64_t hash = leaf->leaf.hash;
+    const void *key = leaf->leaf.key.data;
+    size_t size = leaf->leaf.key.size;
+
+    if (n->kind == PMAP_COLLISION){
+        for (uint32_t index = 0; index < n->branch.count; ++index){
+            if (leaf_matches(n->children[index], hash, size, key)){
+                *replaced = true;
+
+                return node_with(n, 0, index, leaf, false);
+            }
+        }
+
+        return node_with(n, 0, n->branch.count, leaf, true);
+    }
+
+    uint32_t bit = 1u << hash_bits(hash, shift);
+    uint32_t position = __builtin_popcount(n->branch.bitmap & (bit - 1));
+
+    if (!(n->branch.bitmap & bit)){
+        return node_with(n, n->branch.bitmap | bit, position, leaf, true);
+    }
+
+    pmap_node *child = n->children[position];
+    pmap_node *sub;
+
+    if (child->kind != PMAP_LEAF){
+        sub = node_set(child, shift + PMAP_BITS, leaf, replaced);
+    }
+    else if (leaf_matches(child, hash, size, key)){
+        *replaced = true;
+        sub = leaf;
+    }
+    else {
+        sub = node_pair(node_retain(child), leaf, shift + PMAP_BITS);
+
+        if (!sub){
+            node_release(child);
+        }
+    }
+
+    if (!sub){
+        return NULL;
+    }
+
+    pmap_node *copy = node_with(n, n->branch.bitmap, position, sub, false);
+
+    if (!copy && sub != leaf){
+        /* keep leaf alive for the caller, drop the rest of the new path */
+        node_retain(leaf);
+        node_release(sub);
+    }
+
+    return copy;
+}
+
+/*
+ * sets *out to a new version of n without key -- NULL when nothing is
+ * left, or a lone leaf which the parent pulls up. returns false on
+ * allocation failure, *found is false when key was not there
+ */
+static bool node_remove(const pmap_node *n, unsigned shift, uint64_t hash, size_t size, const void *key, pmap_node **out, bool *found){
+    uint32_t count = node_count(n);
+    uint32_t position = 0;
+    uint32_t bitmap = 0;
+    pmap_node *sub = NULL;
+
+    *found = false;
+
+    if (n->kind == PMAP_COLLISION){
+        while (position < count && !leaf_matches(n->children[position], hash, size, key)){
+            ++position;
+        }
+
+        if (position == count){
+            return true;
+        }
+    }
+    else {
+        uint32_t bit = 1u << hash_bits(hash, shift);
+
+        if (!(n->branch.bitmap & bit)){
+            return true;
+        }
+
+        position = __builtin_popcount(n->branch.bitmap & (bit - 1));
+        bitmap = n->branch.bitmap;
+
+        pmap_node *child = n->children[position];
+
+        if (child->kind != PMAP_LEAF){
+            if (!node_remove(child, shift + PMAP_BITS, hash, size, key, &sub, found)){
+                return false;
+            }
+
+            if (!*found){
+                return true;
+            }
+        }
+        else if (!leaf_matches(child, hash, size, key)){
+            return true;
+        }
+
+        if (!sub){
+            bitmap &= ~bit;
+        }
+    }
+
+    *found = true;
+
+    if (sub){
+        /* a lone leaf below moves up into this node's place */
+        if (sub->kind == PMAP_LEAF && count == 1 && shift){
+            *out = sub;
+
+            return true;
+        }
+
+        *out = node_with(n, bitmap, position, sub, false);
+
+        if (!*out){
+            node_release(sub);
+
+            return false;
+        }
+
+        return true;
+    }
+
+    if (count == 1){
+        *out = NULL;
+
+        return true;
+    }
+
+    if (count == 2 && shift){
+        pmap_node *other = n->children[position ^ 1];
+
+        if (other->kind == PMAP_LEAF){
+            *out = node_retain(other);
+
+            return true;
+        }
+    }
+
+    *out = node_with(n, bitmap, position, NULL, false);
+
+    return *out != NULL;
+}
+
+static const pmap_node *find_leaf(const pmap *p, size_t size, const void *key){
+    const pmap_node *n = p->root;
+    uint64_t hash = generate_hash(p, size, key);
+
+    for (unsigned shift = 0; n; shift += PMAP_BITS){
+        if (n->kind == PMAP_LEAF){
+            return leaf_matches(n, hash, size, key) ? n : NULL;
+        }
+        else if (n->kind == PMAP_COLLISION){
+            for (uint32_t index = 0; index < n->branch.count; ++index){
+                if (leaf_matches(n->children[index], hash, size, key)){
+                    return n->children[index];
+                }
+            }
+
+            return NULL;
+        }
+
+        uint32_t bit = 1u << hash_bits(hash, shift);
+
+        if (!(n->branch.bitmap & bit)){
+            return NULL;
+        }
+
+        n = n->children[__builtin_popcount(n->branch.bitmap & (bit - 1))];
+    }
+
+    return NULL;
+}
+
+static const pmap_node *get_leaf(const pmap *p, size_t size, const void *key, mtype type){
+    if (!p){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] get_leaf() - pmap is NULL\n",
+            __FILE__
+        );
+
+        return NULL;
+    }
+    else if (!key){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] get_leaf() - key is NULL\n",
+            __FILE__
+        );
+
+        return NULL;
+    }
+
+    const pmap_node *n = find_leaf(p, size, key);
+
+    if (!n){
+        log_write(
+            logger,
+            LOG_DEBUG,
+            "[%s] get_leaf() - key does not exist\n",
+            __FILE__
+        );
+
+        return NULL;
+    }
+
+    if (type != M_TYPE_RESERVED_EMPTY && n->leaf.value.type != type){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] get_leaf() - leaf type does *not* match\n",
+            __FILE__
+        );
+    }
+
+    return n;
+}
+
+pmap *pmap_init(void){
+    pmap *p = malloc(sizeof(*p));
+
+    if (!p){
+        log_write(
+            logger,
+            LOG_ERROR,
+            "[%s] pmap_init() - pmap alloc failed\n",
+            __FILE__
+        );
+
+        return NULL;
+    }
+
+    p->root = NULL;
+    p->length = 0;
+    p->seed = (uint64_t)&p;
+
+    return p;
+}
+
+pmap *pmap_copy(const pmap *p){
+    if (!p){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] pmap_copy() - pmap is NULL\n",
+            __FILE__
+        );
+
+        return NULL;
+    }
+
+    pmap *copy = malloc(sizeof(*copy));
+
+    if (!copy){
+        log_write(
+            logger,
+            LOG_ERROR,
+            "[%s] pmap_copy() - pmap alloc failed\n",
+            __FILE__
+        );
+
+        return NULL;
+    }
+
+    *copy = *p;
+
+    if (copy->root){
+        node_retain(copy->root);
+    }
+
+    return copy;
+}
+
+size_t pmap_get_length(const pmap *p){
+    if (!p){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] pmap_get_length() - pmap is NULL\n",
+            __FILE__
+        );
+
+        return 0;
+    }
+
+    return p->length;
+}
+
+pmapiter *pmap_iter_init(const pmap *p){
+    if (!p){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] pmap_iter_init() - pmap is NULL\n",
+            __FILE__
+        );
+
+        return NULL;
+    }
+
+    pmapiter *iter = malloc(sizeof(*iter));
+
+    if (!iter){
+        log_write(
+            logger,
+            LOG_ERROR,
+            "[%s] pmap_iter_init() - iter alloc failed\n",
+            __FILE__
+        );
+
+        return NULL;
+    }
+
+    iter->root = p->root ? node_retain(p->root) : NULL;
+    iter->depth = 0;
+    iter->leaf = NULL;
+
+    if (iter->root){
+        iter->nodes[0] = iter->root;
+        iter->indexes[0] = 0;
+        iter->depth = 1;
+    }
+
+    return iter;
+}
+
+bool pmap_iter_get_key(const pmapiter *iter, map_item *key){
+    if (!iter){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] pmap_iter_get_key() - iter is NULL\n",
+            __FILE__
+        );
+
+        return false;
+    }
+    else if (!iter->leaf){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] pmap_iter_get_key() - iter is not on an entry\n",
+            __FILE__
+        );
+
+        return false;
+    }
+    else if (!key){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] pmap_iter_get_key() - key is NULL\n",
+            __FILE__
+        );
+
+        return false;
+    }
+
+    *key = iter->leaf->leaf.key;
+
+    return true;
+}
+
+bool pmap_iter_get_value(const pmapiter *iter, map_item *value){
+    if (!iter){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] pmap_iter_get_value() - iter is NULL\n",
+            __FILE__
+        );
+
+        return false;
+    }
+    else if (!iter->leaf){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] pmap_iter_get_value() - iter is not on an entry\n",
+            __FILE__
+        );
+
+        return false;
+    }
+    else if (!value){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] pmap_iter_get_value() - value is NULL\n",
+            __FILE__
+        );
+
+        return false;
+    }
+
+    *value = iter->leaf->leaf.value;
+
+    return true;
+}
+
+bool pmap_iter_next(pmapiter *iter){
+    if (!iter){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] pmap_iter_next() - iter is NULL\n",
+            __FILE__
+        );
+
+        return false;
+    }
+
+    while (iter->depth){
+        const pmap_node *n = iter->nodes[iter->depth - 1];
+        uint32_t index = iter->indexes[iter->depth - 1]++;
+
+        if (index >= node_count(n)){
+            --iter->depth;
+
+            continue;
+        }
+
+        const pmap_node *child = n->children[index];
+
+        if (child->kind == PMAP_LEAF){
+            iter->leaf = child;
+
+            return true;
+        }
+
+        iter->nodes[iter->depth] = child;
+        iter->indexes[iter->depth] = 0;
+        ++iter->depth;
+    }
+
+    iter->leaf = NULL;
+
+    return false;
+}
+
+void pmap_iter_free(pmapiter *iter){
+    if (!iter){
+        log_write(
+            logger,
+            LOG_DEBUG,
+            "[%s] pmap_iter_free() - iter is NULL\n",
+            __FILE__
+        );
+
+        return;
+    }
+
+    node_release(iter->root);
+
+    free(iter);
+}
+
+mstatus pmap_try_get(const pmap *p, size_t size, const void *key, mtype type, const map_item **value){
+    if (value){
+        *value = NULL;
+    }
+
+    if (!p || !key){
+        return M_STATUS_INVALID;
+    }
+
+    const pmap_node *n = find_leaf(p, size, key);
+
+    if (!n){
+        return M_STATUS_NOT_FOUND;
+    }
+
+    if (value){
+        *value = &n->leaf.value;
+    }
+
+    if (type != M_TYPE_RESERVED_EMPTY && n->leaf.value.type != type){
+        return M_STATUS_TYPE_MISMATCH;
+    }
+
+    return M_STATUS_OK;
+}
+
+bool pmap_contains(const pmap *p, size_t size, const void *key){
+    return get_leaf(p, size, key, M_TYPE_RESERVED_EMPTY);
+}
+
+mtype pmap_get_type(const pmap *p, size_t size, const void *key){
+    const pmap_node *n = get_leaf(p, size, key, M_TYPE_RESERVED_EMPTY);
+
+    if (!n){
+        return M_TYPE_RESERVED_ERROR;
+    }
+
+    return n->leaf.value.type;
+}
+
+bool pmap_get_bool(const pmap *p, size_t size, const void *key){
+    const pmap_node *n = get_leaf(p, size, key, M_TYPE_BOOL);
+
+    if (!n){
+        return false;
+    }
+
+    return *(bool *)n->leaf.value.data;
+}
+
+char pmap_get_char(const pmap *p, size_t size, const void *key){
+    const pmap_node *n = get_leaf(p, size, key, M_TYPE_CHAR);
+
+    if (!n){
+        return 0;
+    }
+
+    return *(char *)n->leaf.value.data;
+}
+
+double pmap_get_double(const pmap *p, size_t size, const void *key){
+    const pmap_node *n = get_leaf(p, size, key, M_TYPE_DOUBLE);
+
+    if (!n){
+        return 0.0;
+    }
+
+    return *(double *)n->leaf.value.data;
+}
+
+int64_t pmap_get_int(const pmap *p, size_t size, const void *key){
+    const pmap_node *n = get_leaf(p, size, key, M_TYPE_INT);
+
+    if (!n){
+        return 0;
+    }
+
+    return *(int64_t *)n->leaf.value.data;
+}
+
+uint64_t pmap_get_uint(const pmap *p, size_t size, const void *key){
+    const pmap_node *n = get_leaf(p, size, key, M_TYPE_UINT);
+
+    if (!n){
+        return 0;
+    }
+
+    return *(uint64_t *)n->leaf.value.data;
+}
+
+size_t pmap_get_size_t(const pmap *p, size_t size, const void *key){
+    const pmap_node *n = get_leaf(p, size, key, M_TYPE_SIZE_T);
+
+    if (!n){
+        return 0;
+    }
+
+    return *(size_t *)n->leaf.value.data;
+}
+
+/*
+ * READ WARNING FOR THESE FUNCTIONS IN HEADER FILE
+ */
+const char *pmap_get_string(const pmap *p, size_t size, const void *key){
+    const pmap_node *n = get_leaf(p, size, key, M_TYPE_STRING);
+
+    if (!n){
+        return NULL;
+    }
+
+    return n->leaf.value.data;
+}
+
+const list *pmap_get_list(const pmap *p, size_t size, const void *key){
+    const pmap_node *n = get_leaf(p, size, key, M_TYPE_LIST);
+
+    if (!n){
+        return NULL;
+    }
+
+    return n->leaf.value.data;
+}
+
+const map *pmap_get_map(const pmap *p, size_t size, const void *key){
+    const pmap_node *n = get_leaf(p, size, key, M_TYPE_MAP);
+
+    if (!n){
+        return NULL;
+    }
+
+    return n->leaf.value.data;
+}
+
+const void *pmap_get_generic(const pmap *p, size_t size, const void *key){
+    const pmap_node *n = get_leaf(p, size, key, M_TYPE_GENERIC);
+
+    if (!n){
+        return NULL;
+    }
+
+    return n->leaf.value.data;
+}
+
+bool pmap_set(pmap *p, const map_item *key, const map_item *value){
+    if (!p){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] pmap_set() - pmap is NULL\n",
+            __FILE__
+        );
+
+        return false;
+    }
+    else if (!key || !value){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] pmap_set() - key or value is NULL\n",
+            __FILE__
+        );
+
+        return false;
+    }
+    else if (key->data){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] pmap_set() - key will *always* be copied -- set key in data_copy instead\n",
+            __FILE__
+        );
+
+        return false;
+    }
+
+    pmap_node *leaf = leaf_init(generate_hash(p, key->size, key->data_copy), key, value);
+
+    if (!leaf){
+        log_write(
+            logger,
+            LOG_ERROR,
+            "[%s] pmap_set() - leaf_init call failed\n",
+            __FILE__
+        );
+
+        return false;
+    }
+
+    bool replaced = false;
+    pmap_node *root;
+
+    if (p->root){
+        root = node_set(p->root, 0, leaf, &replaced);
+    }
+    else {
+        root = node_alloc(PMAP_BRANCH, 1);
+
+        if (root){
+            root->branch.bitmap = 1u << hash_bits(leaf->leaf.hash, 0);
+            root->branch.count = 1;
+            root->children[0] = leaf;
+        }
+    }
+
+    if (!root){
+        log_write(
+            logger,
+            LOG_ERROR,
+            "[%s] pmap_set() - path copy failed\n",
+            __FILE__
+        );
+
+        /* value->data stays with the caller on failure */
+        if (value->data){
+            leaf->leaf.value.type = M_TYPE_NULL;
+        }
+
+        node_release(leaf);
+
+        return false;
+    }
+
+    node_release(p->root);
+
+    p->root = root;
+
+    if (!replaced){
+        ++p->length;
+    }
+
+    return true;
+}
+
+void pmap_remove(pmap *p, size_t size, const void *key){
+    if (!p){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] pmap_remove() - pmap is NULL\n",
+            __FILE__
+        );
+
+        return;
+    }
+    else if (!key){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] pmap_remove() - key is NULL\n",
+            __FILE__
+        );
+
+        return;
+    }
+
+    bool found = false;
+    pmap_node *root = NULL;
+
+    if (p->root && !node_remove(p->root, 0, generate_hash(p, size, key), size, key, &root, &found)){
+        log_write(
+            logger,
+            LOG_ERROR,
+            "[%s] pmap_remove() - path copy failed\n",
+            __FILE__
+        );
+
+        return;
+    }
+
+    if (!found){
+        log_write(
+            logger,
+            LOG_DEBUG,
+            "[%s] pmap_remove() - key does not exist\n",
+            __FILE__
+        );
+
+        return;
+    }
+
+    node_release(p->root);
+
+    p->root = root;
+
+    --p->length;
+}
+
+void pmap_free(pmap *p){
+    if (!p){
+        log_write(
+            logger,
+            LOG_DEBUG,
+            "[%s] pmap_free() - pmap is NULL\n",
+            __FILE__
+        );
+
+        return;
+    }
+
+    node_release(p->root);
+
+    free(p);
+}
@@ -0,0 +1,77 @@
+#ifndef PMAP_H
+#define PMAP_H
+
+#include "map.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * persistent map -- a hash array mapped trie (32-way branches) whose
+ * nodes are never changed once built. pmap_set/pmap_remove copy only
+ * the O(log32 n) nodes on the path to the key and share the rest, so
+ * pmap_copy is a reference count bump. copies can be used from other
+ * threads, a single pmap must not be modified concurrently. iteration
+ * order is unspecified
+ */
+
+/* 13 branch levels consume the 64-bit hash, then a collision node */
+#define PMAP_MAX_DEPTH 14
+
+typedef struct pmap_node pmap_node;
+
+typedef struct pmap {
+    pmap_node *root;
+    size_t length;
+    uint64_t seed;
+} pmap;
+
+/* holds a reference so the snapshot stays valid while iterating */
+typedef struct pmapiter {
+    pmap_node *root;
+    const pmap_node *nodes[PMAP_MAX_DEPTH];
+    uint32_t indexes[PMAP_MAX_DEPTH];
+    size_t depth;
+    const pmap_node *leaf;
+} pmapiter;
+
+pmap *pmap_init(void);
+pmap *pmap_copy(const pmap *);
+
+size_t pmap_get_length(const pmap *);
+
+pmapiter *pmap_iter_init(const pmap *);
+bool pmap_iter_get_key(const pmapiter *, map_item *);
+bool pmap_iter_get_value(const pmapiter *, map_item *);
+bool pmap_iter_next(pmapiter *);
+void pmap_iter_free(pmapiter *);
+
+/* silent lookup, same as map_try_get */
+mstatus pmap_try_get(const pmap *, size_t, const void *, mtype, const map_item **);
+
+bool pmap_contains(const pmap *, size_t, const void *);
+mtype pmap_get_type(const pmap *, size_t, const void *);
+bool pmap_get_bool(const pmap *, size_t, const void *);
+char pmap_get_char(const pmap *, size_t, const void *);
+double pmap_get_double(const pmap *, size_t, const void *);
+int64_t pmap_get_int(const pmap *, size_t, const void *);
+uint64_t pmap_get_uint(const pmap *, size_t, const void *);
+size_t pmap_get_size_t(const pmap *, size_t, const void *);
+
+/* ------------------ WARNING ------------------
+ * values are shared with every copy of the pmap.
+ * the data at these pointers MUST NOT be modified
+ * or free'd -- set a new value instead
+ */
+const char *pmap_get_string(const pmap *, size_t, const void *);
+const list *pmap_get_list(const pmap *, size_t, const void *);
+const map *pmap_get_map(const pmap *, size_t, const void *);
+const void *pmap_get_generic(const pmap *, size_t, const void *);
+
+/* same rules as map_set -- the key is copied, value->data is taken over */
+bool pmap_set(pmap *, const map_item *, const map_item *);
+void pmap_remove(pmap *, size_t, const void *);
+void pmap_free(pmap *);
+
+#endif
@@ -0,0 +1,494 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "rmap.h"
+
+#include "list.h"
+#include "log.h"
+#include "str.h"
+
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/* reader slots are padded to a cache line so threads don't false share */
+#define RMAP_CACHE_LINE 64
+
+static logctx *logger = NULL;
+
+/* readers inside an epoch, by epoch parity */
+typedef struct rmap_slot {
+    _Alignas(RMAP_CACHE_LINE) atomic_size_t readers[2];
+} rmap_slot;
+
+/* hands out reader ids, 0 means the thread has none yet */
+static atomic_size_t threads = 0;
+static _Thread_local size_t threadid = 0;
+
+static rmap_slot *get_slot(rmap *r){
+    if (!threadid){
+        threadid = atomic_fetch_add(&threads, 1) + 1;
+    }
+
+    return r->slots + threadid % RMAP_READER_SLOTS;
+}
+
+/*
+ * a reader counts itself under the current epoch's parity and checks
+ * the epoch did not move meanwhile -- otherwise a writer could have
+ * missed it while waiting
+ */
+static unsigned epoch_enter(rmap *r){
+    rmap_slot *slot = get_slot(r);
+
+    for (;;){
+        unsigned epoch = atomic_load(&r->epoch);
+
+        atomic_fetch_add(&slot->readers[epoch & 1], 1);
+
+        if (atomic_load(&r->epoch) == epoch){
+            return epoch & 1;
+        }
+
+        atomic_fetch_sub(&slot->readers[epoch & 1], 1);
+    }
+}
+
+static void epoch_exit(rmap *r, unsigned parity){
+    atomic_fetch_sub(&get_slot(r)->readers[parity & 1], 1);
+}
+
+/*
+ * called with the write lock held after publishing a new snapshot.
+ * readers that entered after the flip see the new snapshot, so only
+ * the ones counted under the old parity have to drain
+ */
+static void epoch_synchronize(rmap *r){
+    unsigned parity = atomic_fetch_add(&r->epoch, 1) & 1;
+
+    for (size_t index = 0; index < RMAP_READER_SLOTS; ++index){
+        while (atomic_load(&r->slots[index].readers[parity])){
+            sched_yield();
+        }
+    }
+}
+
+/* swaps in next and frees the snapshot it replaced once it is unreachable */
+static void publish(rmap *r, pmap *next){
+    pmap *old = atomic_load(&r->current);
+
+    atomic_store(&r->current, next);
+
+    epoch_synchronize(r);
+
+    pmap_free(old);
+}
+
+static mstatus read_value(rmap *r, size_t size, const void *key, mtype type, void (*copy)(const map_item *, void *), void *out){
+    if (!r || !key){
+        return M_STATUS_INVALID;
+    }
+
+    const map_item *value = NULL;
+    unsigned parity = epoch_enter(r);
+
+    mstatus status = pmap_try_get(atomic_load(&r->current), size, key, type, &value);
+
+    if (status == M_STATUS_OK && copy){
+        copy(value, out);
+    }
+
+    epoch_exit(r, parity);
+
+    return status;
+}
+
+/* misses and type mismatches are silent -- readers run concurrently and stay off the logger */
+static void log_status(mstatus status, const char *func){
+    if (status == M_STATUS_INVALID){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] %s() - rmap or key is NULL\n",
+            __FILE__,
+            func
+        );
+    }
+}
+
+static void copy_type(const map_item *value, void *out){
+    *(mtype *)out = value->type;
+}
+
+static void copy_bool(const map_item *value, void *out){
+    *(bool *)out = *(bool *)value->data;
+}
+
+static void copy_char(const map_item *value, void *out){
+    *(char *)out = *(char *)value->data;
+}
+
+static void copy_double(const map_item *value, void *out){
+    *(double *)out = *(double *)value->data;
+}
+
+static void copy_int(const map_item *value, void *out){
+    *(int64_t *)out = *(int64_t *)value->data;
+}
+
+static void copy_uint(const map_item *value, void *out){
+    *(uint64_t *)out = *(uint64_t *)value->data;
+}
+
+static void copy_size_t(const map_item *value, void *out){
+    *(size_t *)out = *(size_t *)value->data;
+}
+
+static void copy_string(const map_item *value, void *out){
+    char *string = malloc(value->size + 1);
+
+    if (string){
+        memcpy(string, value->data, value->size);
+
+        string[value->size] = '\0';
+    }
+
+    *(char **)out = string;
+}
+
+static void copy_list(const map_item *value, void *out){
+    *(list **)out = list_copy(value->data);
+}
+
+static void copy_map(const map_item *value, void *out){
+    *(map **)out = map_copy(value->data);
+}
+
+rmap *rmap_init(void){
+    rmap *r = malloc(sizeof(*r));
+
+    if (!r){
+        log_write(
+            logger,
+            LOG_ERROR,
+            "[%s] rmap_init() - rmap alloc failed\n",
+            __FILE__
+        );
+
+        return NULL;
+    }
+
+    r->slots = aligned_alloc(RMAP_CACHE_LINE, RMAP_READER_SLOTS * sizeof(*r->slots));
+
+    if (!r->slots){
+        log_write(
+            logger,
+            LOG_ERROR,
+            "[%s] rmap_init() - slots alloc failed\n",
+            __FILE__
+        );
+
+        free(r);
+
+        return NULL;
+    }
+
+    for (size_t index = 0; index < RMAP_READER_SLOTS; ++index){
+        atomic_init(&r->slots[index].readers[0], 0);
+        atomic_init(&r->slots[index].readers[1], 0);
+    }
+
+    pmap *p = pmap_init();
+
+    if (!p || pthread_mutex_init(&r->lock, NULL)){
+        log_write(
+            logger,
+            LOG_ERROR,
+            "[%s] rmap_init() - initialization failed\n",
+            __FILE__
+        );
+
+        pmap_free(p);
+        free(r->slots);
+        free(r);
+
+        return NULL;
+    }
+
+    atomic_init(&r->current, p);
+    atomic_init(&r->epoch, 0);
+
+    return r;
+}
+
+size_t rmap_get_length(rmap *r){
+    if (!r){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] rmap_get_length() - rmap is NULL\n",
+            __FILE__
+        );
+
+        return 0;
+    }
+
+    unsigned parity = epoch_enter(r);
+    size_t length = pmap_get_length(atomic_load(&r->current));
+
+    epoch_exit(r, parity);
+
+    return length;
+}
+
+const pmap *rmap_read_lock(rmap *r, unsigned *parity){
+    if (!r || !parity){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] rmap_read_lock() - rmap or parity is NULL\n",
+            __FILE__
+        );
+
+        return NULL;
+    }
+
+    *parity = epoch_enter(r);
+
+    return atomic_load(&r->current);
+}
+
+void rmap_read_unlock(rmap *r, unsigned parity){
+    if (!r){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] rmap_read_unlock() - rmap is NULL\n",
+            __FILE__
+        );
+
+        return;
+    }
+
+    epoch_exit(r, parity);
+}
+
+bool rmap_contains(rmap *r, size_t size, const void *key){
+    mstatus status = read_value(r, size, key, M_TYPE_RESERVED_EMPTY, NULL, NULL);
+
+    if (status == M_STATUS_INVALID){
+        log_status(status, __func__);
+    }
+
+    return status == M_STATUS_OK;
+}
+
+mtype rmap_get_type(rmap *r, size_t size, const void *key){
+    mtype type = M_TYPE_RESERVED_ERROR;
+    mstatus status = read_value(r, size, key, M_TYPE_RESERVED_EMPTY, copy_type, &type);
+
+    log_status(status, __func__);
+
+    return type;
+}
+
+bool rmap_get_bool(rmap *r, size_t size, const void *key){
+    bool value = false;
+    mstatus status = read_value(r, size, key, M_TYPE_BOOL, copy_bool, &value);
+
+    log_status(status, __func__);
+
+    return value;
+}
+
+char rmap_get_char(rmap *r, size_t size, const void *key){
+    char value = 0;
+    mstatus status = read_value(r, size, key, M_TYPE_CHAR, copy_char, &value);
+
+    log_status(status, __func__);
+
+    return value;
+}
+
+double rmap_get_double(rmap *r, size_t size, const void *key){
+    double value = 0.0;
+    mstatus status = read_value(r, size, key, M_TYPE_DOUBLE, copy_double, &value);
+
+    log_status(status, __func__);
+
+    return value;
+}
+
+int64_t rmap_get_int(rmap *r, size_t size, const void *key){
+    int64_t value = 0;
+    mstatus status = read_value(r, size, key, M_TYPE_INT, copy_int, &value);
+
+    log_status(status, __func__);
+
+    return value;
+}
+
+uint64_t rmap_get_uint(rmap *r, size_t size, const void *key){
+    uint64_t value = 0;
+    mstatus status = read_value(r, size, key, M_TYPE_UINT, copy_uint, &value);
+
+    log_status(status, __func__);
+
+    return value;
+}
+
+size_t rmap_get_size_t(rmap *r, size_t size, const void *key){
+    size_t value = 0;
+    mstatus status = read_value(r, size, key, M_TYPE_SIZE_T, copy_size_t, &value);
+
+    log_status(status, __func__);
+
+    return value;
+}
+
+char *rmap_get_string(rmap *r, size_t size, const void *key){
+    char *value = NULL;
+    mstatus status = read_value(r, size, key, M_TYPE_STRING, copy_string, &value);
+
+    log_status(status, __func__);
+
+    return value;
+}
+
+list *rmap_get_list(rmap *r, size_t size, const void *key){
+    list *value = NULL;
+    mstatus status = read_value(r, size, key, M_TYPE_LIST, copy_list, &value);
+
+    log_status(status, __func__);
+
+    return value;
+}
+
+map *rmap_get_map(rmap *r, size_t size, const void *key){
+    map *value = NULL;
+    mstatus status = read_value(r, size, key, M_TYPE_MAP, copy_map, &value);
+
+    log_status(status, __func__);
+
+    return value;
+}
+
+bool rmap_set(rmap *r, const map_item *key, const map_item *value){
+    if (!r){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] rmap_set() - rmap is NULL\n",
+            __FILE__
+        );
+
+        return false;
+    }
+
+    pthread_mutex_lock(&r->lock);
+
+    pmap *next = pmap_copy(atomic_load(&r->current));
+
+    if (!next || !pmap_set(next, key, value)){
+        log_write(
+            logger,
+            LOG_ERROR,
+            "[%s] rmap_set() - unable to build the next snapshot\n",
+            __FILE__
+        );
+
+        pmap_free(next);
+        pthread_mutex_unlock(&r->lock);
+
+        return false;
+    }
+
+    publish(r, next);
+
+    pthread_mutex_unlock(&r->lock);
+
+    return true;
+}
+
+void rmap_remove(rmap *r, size_t size, const void *key){
+    if (!r){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] rmap_remove() - rmap is NULL\n",
+            __FILE__
+        );
+
+        return;
+    }
+
+    pthread_mutex_lock(&r->lock);
+
+    pmap *next = pmap_copy(atomic_load(&r->current));
+
+    if (!next){
+        log_write(
+            logger,
+            LOG_ERROR,
+            "[%s] rmap_remove() - pmap_copy call failed\n",
+            __FILE__
+        );
+
+        pthread_mutex_unlock(&r->lock);
+
+        return;
+    }
+
+    size_t length = pmap_get_length(next);
+
+    pmap_remove(next, size, key);
+
+    if (pmap_get_length(next) == length){
+        /* nothing removed -- keep the current snapshot */
+        pmap_free(next);
+    }
+    else {
+        publish(r, next);
+    }
+
+    pthread_mutex_unlock(&r->lock);
+}
+
+bool rmap_replace(rmap *r, pmap *p){
+    if (!r || !p){
+        log_write(
+            logger,
+            LOG_WARNING,
+            "[%s] rmap_replace() - rmap or pmap is NULL\n",
+            __FILE__
+        );
+
+        return false;
+    }
+
+    pthread_mutex_lock(&r->lock);
+
+    publish(r, p);
+
+    pthread_mutex_unlock(&r->lock);
+
+    return true;
+}
+
+void rmap_free(rmap *r){
+    if (!r){
+        log_write(
+            logger,
+            LOG_DEBUG,
+            "[%s] rmap_free() - rmap is NULL\n",
+            __FILE__
+        );
+
+        return;
+    }
+
+    pmap_free(atomic_load(&r->current));
+    pthread_mutex_destroy(&r->lock);
+
+    free(r->slots);
+    free(r);
+}
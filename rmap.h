@@ -0,0 +1,68 @@
+#ifndef RMAP_H
+#define RMAP_H
+
+#include "map.h"
+#include "pmap.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * read mostly concurrent map. readers never lock -- they enter an
+ * epoch and read the current pmap snapshot. writers are serialized,
+ * build the next snapshot by path copying and publish it atomically.
+ * the old snapshot is freed once every reader that could have seen it
+ * has left its epoch. writes wait for that, so they are the slow side
+ */
+
+/* threads are spread over this many reader counters */
+#define RMAP_READER_SLOTS 64
+
+typedef struct rmap_slot rmap_slot;
+
+typedef struct rmap {
+    _Atomic(pmap *) current;
+    atomic_uint epoch;
+    rmap_slot *slots;
+    pthread_mutex_t lock;
+} rmap;
+
+rmap *rmap_init(void);
+
+size_t rmap_get_length(rmap *);
+
+/*
+ * the snapshot stays valid, and pointers taken from it, until
+ * rmap_read_unlock is called with the returned epoch
+ */
+const pmap *rmap_read_lock(rmap *, unsigned *);
+void rmap_read_unlock(rmap *, unsigned);
+
+/* misses and type mismatches aren't logged, they return 0 / NULL */
+bool rmap_contains(rmap *, size_t, const void *);
+mtype rmap_get_type(rmap *, size_t, const void *);
+bool rmap_get_bool(rmap *, size_t, const void *);
+char rmap_get_char(rmap *, size_t, const void *);
+double rmap_get_double(rmap *, size_t, const void *);
+int64_t rmap_get_int(rmap *, size_t, const void *);
+uint64_t rmap_get_uint(rmap *, size_t, const void *);
+size_t rmap_get_size_t(rmap *, size_t, const void *);
+
+/* copies -- the caller owns them. see rmap_read_lock to avoid copying */
+char *rmap_get_string(rmap *, size_t, const void *);
+list *rmap_get_list(rmap *, size_t, const void *);
+map *rmap_get_map(rmap *, size_t, const void *);
+
+bool rmap_set(rmap *, const map_item *, const map_item *);
+void rmap_remove(rmap *, size_t, const void *);
+
+/* publishes the pmap as the new contents and takes it over */
+bool rmap_replace(rmap *, pmap *);
+
+/* no reader may be inside rmap_read_lock */
+void rmap_free(rmap *);
+
+#endif
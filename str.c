@@ -377,7 +377,9 @@ bool string_from_time(time_t timet, bool local, const char *format, char *output
         timet = time(NULL);
     }
 
-    struct tm *timetm = local ? localtime(&timet) : gmtime(&timet);
+    /* the reentrant versions -- the logger calls this from concurrent readers */
+    struct tm timebuf;
+    struct tm *timetm = local ? localtime_r(&timet, &timebuf) : gmtime_r(&timet, &timebuf);
 
     if (!timetm){
         log_write(
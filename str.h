@@ -7,6 +7,7 @@
 #include <stdbool.h>
 #include <stddef.h>
 #include <string.h>
+#include <time.h>
 
 char *string_create(const char *, ...);
 bool string_copy(const char *, char *, size_t);
@@ -0,0 +1,127 @@
+/*
+ * the atom table is bounded, atom keyed maps copy the keys it turns
+ * away. run with make test
+ */
+#include "atom.h"
+#include "map.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CHECK(x) do { \
+    if (!(x)){ \
+        fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #x); \
+        return false; \
+    } \
+} while (0)
+
+#define TEST_KEYS (ATOM_MAXIMUM_LENGTH + 500)
+
+static bool set_key(map *m, const char *key, int64_t value){
+    map_item k = {.type = M_TYPE_STRING, .size = strlen(key), .data_copy = key};
+    map_item v = {.type = M_TYPE_INT, .size = sizeof(value), .data_copy = &value};
+
+    return map_set(m, &k, &v);
+}
+
+static bool test_bounded(void){
+    char key[ATOM_MAXIMUM_SIZE + 2];
+
+    memset(key, 'a', sizeof(key) - 1);
+    key[sizeof(key) - 1] = '\0';
+
+    CHECK(!atom_intern(strlen(key), key));
+
+    for (int index = 0; index < TEST_KEYS; ++index){
+        snprintf(key, sizeof(key), "key%d", index);
+
+        atom_intern(strlen(key), key);
+    }
+
+    CHECK(atom_get_length() == ATOM_MAXIMUM_LENGTH);
+
+    /* atoms that exist are still found once the table is full */
+    CHECK(atom_intern(4, "key0"));
+
+    return true;
+}
+
+static bool test_fallback(void){
+    map_options options = {.atoms = true};
+    map *m = map_init_ex(&options);
+    char key[ATOM_MAXIMUM_SIZE + 16];
+
+    CHECK(m);
+
+    /* the first keys are atoms, the rest and the long ones are copied */
+    for (int index = 0; index < TEST_KEYS; ++index){
+        snprintf(key, sizeof(key), "key%d", index);
+
+        CHECK(set_key(m, key, index));
+    }
+
+    CHECK(set_key(m, "a key that is far too long to be interned as an atom by the table", -1));
+
+    map *copy = map_copy(m);
+
+    CHECK(copy);
+
+    map_free(m);
+
+    CHECK(map_get_length(copy) == TEST_KEYS + 1);
+
+    for (int index = 0; index < TEST_KEYS; ++index){
+        snprintf(key, sizeof(key), "key%d", index);
+
+        CHECK(map_get_int(copy, strlen(key), key) == index);
+    }
+
+    map_free(copy);
+
+    return true;
+}
+
+/* map_from_arrays mixes borrowed atoms and keys copied into one block */
+static bool test_set_many(void){
+    static char names[TEST_KEYS][16];
+    static map_item keys[TEST_KEYS];
+    static map_item values[TEST_KEYS];
+    static int64_t numbers[TEST_KEYS];
+
+    for (int index = 0; index < TEST_KEYS; ++index){
+        /* every tenth key repeats an earlier one and overwrites it */
+        int name = index % 10 == 9 ? index - 5 : index;
+
+        snprintf(names[index], sizeof(names[index]), "many%d", name);
+
+        numbers[index] = index;
+        keys[index] = (map_item){.type = M_TYPE_STRING, .size = strlen(names[index]), .data_copy = names[index]};
+        values[index] = (map_item){.type = M_TYPE_INT, .size = sizeof(int64_t), .data_copy = numbers + index};
+    }
+
+    map_options options = {.atoms = true};
+    map *m = map_from_arrays(&options, TEST_KEYS, keys, values);
+
+    CHECK(m);
+
+    for (int index = 0; index < TEST_KEYS; ++index){
+        int64_t expected = index % 10 == 4 && index + 5 < TEST_KEYS ? index + 5 : index;
+
+        CHECK(map_get_int(m, keys[index].size, names[index]) == expected);
+    }
+
+    map_free(m);
+
+    return true;
+}
+
+int main(void){
+    if (!test_bounded() || !test_fallback() || !test_set_many()){
+        return EXIT_FAILURE;
+    }
+
+    puts("atom ok");
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,107 @@
+/*
+ * cache round trips -- values set are read back through the index,
+ * so every check here goes through a cache hit. run with make test
+ */
+#include "cache.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CHECK(x) do { \
+    if (!(x)){ \
+        fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #x); \
+        return false; \
+    } \
+} while (0)
+
+static bool set_int(cache *c, const char *key, int64_t value){
+    map_item k = {.type = M_TYPE_STRING, .size = strlen(key), .data_copy = key};
+    map_item v = {.type = M_TYPE_INT, .size = sizeof(value), .data_copy = &value};
+
+    return cache_set(c, &k, &v);
+}
+
+static bool test_hit(void){
+    cache_options options = {.capacity = 4};
+    cache *c = cache_init(&options);
+
+    CHECK(c);
+    CHECK(set_int(c, "answer", 42));
+    CHECK(cache_contains(c, 6, "answer"));
+    CHECK(cache_get_int(c, 6, "answer") == 42);
+
+    const map_item *value = cache_get(c, 6, "answer");
+
+    CHECK(value && value->type == M_TYPE_INT);
+    CHECK(*(int64_t *)map_item_get_data(value) == 42);
+
+    cache_stats stats;
+
+    CHECK(cache_get_stats(c, &stats));
+    CHECK(stats.hits == 2 && stats.misses == 0);
+
+    cache_free(c);
+
+    return true;
+}
+
+static bool test_evict(void){
+    cache_options options = {.capacity = 2};
+    cache *c = cache_init(&options);
+
+    CHECK(c);
+    CHECK(set_int(c, "a", 1));
+    CHECK(set_int(c, "b", 2));
+
+    /* a becomes the most recent, so b is evicted next */
+    CHECK(cache_get_int(c, 1, "a") == 1);
+    CHECK(set_int(c, "c", 3));
+
+    CHECK(cache_get_length(c) == 2);
+    CHECK(!cache_contains(c, 1, "b"));
+    CHECK(cache_get_int(c, 1, "a") == 1);
+    CHECK(cache_get_int(c, 1, "c") == 3);
+
+    cache_free(c);
+
+    return true;
+}
+
+/* string keys and values are sized slices, they need not be terminated */
+static bool test_slices(void){
+    char *buffer = malloc(8);
+
+    CHECK(buffer);
+
+    memcpy(buffer, "keyvalue", 8);
+
+    cache_options options = {.capacity = 4};
+    cache *c = cache_init(&options);
+
+    CHECK(c);
+
+    map_item k = {.type = M_TYPE_STRING, .size = 3, .data_copy = buffer};
+    map_item v = {.type = M_TYPE_STRING, .size = 5, .data_copy = buffer + 3};
+
+    CHECK(cache_set(c, &k, &v));
+
+    const char *value = cache_get_string(c, 3, "key");
+
+    CHECK(value && !strcmp(value, "value"));
+
+    cache_free(c);
+    free(buffer);
+
+    return true;
+}
+
+int main(void){
+    if (!test_hit() || !test_evict() || !test_slices()){
+        return EXIT_FAILURE;
+    }
+
+    puts("cache ok");
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,79 @@
+/*
+ * cmap keys go to their shard with the hash the shard stores them
+ * under, so every write has to be found again by reads. run with make test
+ */
+#include "cmap.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define CHECK(x) do { \
+    if (!(x)){ \
+        fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #x); \
+        return false; \
+    } \
+} while (0)
+
+static bool set_uint(cmap *c, uint64_t key, uint64_t value){
+    map_item k = {.type = M_TYPE_UINT, .size = sizeof(key), .data_copy = &key};
+    map_item v = {.type = M_TYPE_UINT, .size = sizeof(value), .data_copy = &value};
+
+    return cmap_set(c, &k, &v);
+}
+
+static bool test_round_trip(void){
+    cmap *c = cmap_init(8);
+
+    CHECK(c);
+
+    for (uint64_t key = 0; key < 1000; ++key){
+        CHECK(set_uint(c, key, key * 3));
+    }
+
+    CHECK(cmap_get_length(c) == 1000);
+
+    /* overwrites land on the entry that is already there */
+    for (uint64_t key = 0; key < 1000; key += 2){
+        CHECK(set_uint(c, key, key));
+    }
+
+    CHECK(cmap_get_length(c) == 1000);
+
+    for (uint64_t key = 0; key < 1000; ++key){
+        CHECK(cmap_get_uint(c, sizeof(key), &key) == (key % 2 ? key * 3 : key));
+    }
+
+    for (uint64_t key = 0; key < 1000; key += 4){
+        map_item value = {0};
+
+        cmap_pop(c, sizeof(key), &key, &value);
+
+        CHECK(value.type == M_TYPE_UINT && *(uint64_t *)value.data == key);
+
+        free(value.data);
+    }
+
+    for (uint64_t key = 1; key < 1000; key += 4){
+        cmap_remove(c, sizeof(key), &key);
+    }
+
+    CHECK(cmap_get_length(c) == 500);
+
+    for (uint64_t key = 0; key < 1000; ++key){
+        CHECK(cmap_contains(c, sizeof(key), &key) == (key % 4 > 1));
+    }
+
+    cmap_free(c);
+
+    return true;
+}
+
+int main(void){
+    if (!test_round_trip()){
+        return EXIT_FAILURE;
+    }
+
+    puts("cmap ok");
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,195 @@
+/*
+ * map behaviour that the other modules build on. run with make test
+ */
+#include "map.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CHECK(x) do { \
+    if (!(x)){ \
+        fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #x); \
+        return false; \
+    } \
+} while (0)
+
+static bool set_uint(map *m, uint64_t key, uint64_t value){
+    map_item k = {.type = M_TYPE_UINT, .size = sizeof(key), .data_copy = &key};
+    map_item v = {.type = M_TYPE_UINT, .size = sizeof(value), .data_copy = &value};
+
+    return map_set(m, &k, &v);
+}
+
+/* NULL keys are reported missing without being hashed */
+static bool test_get_many_null(void){
+    map *m = map_init();
+
+    CHECK(m);
+
+    for (uint64_t key = 0; key < 40; ++key){
+        CHECK(set_uint(m, key, key * 2));
+    }
+
+    uint64_t present[40];
+    const void *keys[40];
+    size_t sizes[40];
+    map_item values[40];
+
+    for (size_t index = 0; index < 40; ++index){
+        present[index] = index;
+        keys[index] = index % 3 ? present + index : NULL;
+        sizes[index] = sizeof(uint64_t);
+    }
+
+    CHECK(map_get_many(m, 40, keys, sizes, values) == 26);
+
+    for (size_t index = 0; index < 40; ++index){
+        if (index % 3){
+            CHECK(values[index].type == M_TYPE_UINT);
+            CHECK(*(uint64_t *)values[index].data == index * 2);
+        }
+        else {
+            CHECK(values[index].type == M_TYPE_RESERVED_ERROR);
+        }
+    }
+
+    map_free(m);
+
+    return true;
+}
+
+/*
+ * remove + insert churn on an incremental map. no single set may
+ * rebuild the whole index -- every resize has to start as an
+ * incremental rehash -- and the nodes get compacted in steps
+ */
+static bool test_incremental_churn(mprobe probe){
+    map_options options = {.probe = probe, .resize = M_RESIZE_INCREMENTAL};
+    map *m = map_init_ex(&options);
+    uint64_t *live = malloc(20000 * sizeof(*live));
+    uint64_t next = 0;
+    bool compacted = false;
+
+    CHECK(m && live);
+
+    for (size_t index = 0; index < 20000; ++index){
+        live[index] = next++;
+
+        CHECK(set_uint(m, live[index], live[index]));
+    }
+
+    size_t resizes = m->resizes;
+
+    for (size_t op = 0; op < 200000; ++op){
+        size_t victim = (op * 7919) % 20000;
+
+        map_remove(m, sizeof(live[victim]), live + victim);
+
+        live[victim] = next++;
+
+        CHECK(set_uint(m, live[victim], live[victim]));
+
+        if (m->resizes != resizes){
+            CHECK(m->rehash.ctrl);
+
+            resizes = m->resizes;
+        }
+
+        compacted |= m->compacting;
+    }
+
+    CHECK(compacted);
+    CHECK(map_get_length(m) == 20000);
+
+    /* nodes only grow while a compaction is behind, so they stay bounded */
+    CHECK(m->nodessize <= 4 * 32768);
+
+    for (size_t index = 0; index < 20000; ++index){
+        CHECK(map_get_uint(m, sizeof(live[index]), live + index) == live[index]);
+    }
+
+    map_free(m);
+    free(live);
+
+    return true;
+}
+
+/* 16 consecutive keys share a home group, so removals leave tombstones */
+static uint64_t clustered(const void *key, size_t size, uint64_t seed){
+    (void)size;
+    (void)seed;
+
+    uint64_t k = *(const uint64_t *)key;
+
+    return (k / 16) << 7 | (k & 127);
+}
+
+/*
+ * deletes that leave the table mostly tombstones force a rebuild at
+ * the same size. incremental maps have to spread it over many sets
+ */
+static bool test_tombstone_rebuild(void){
+    map_options options = {.resize = M_RESIZE_INCREMENTAL, .hasher = clustered};
+    map *m = map_init_ex(&options);
+    uint64_t key = 0;
+
+    CHECK(m && map_reserve(m, 3200));
+    CHECK(m->table.size == 4096);
+
+    for (; key < 3200; ++key){
+        CHECK(set_uint(m, key, key));
+    }
+
+    for (uint64_t removed = 0; removed < 1850; ++removed){
+        map_remove(m, sizeof(removed), &removed);
+    }
+
+    CHECK(m->table.deleted == 1850);
+
+    size_t resizes = m->resizes;
+
+    while (m->resizes == resizes){
+        CHECK(set_uint(m, key, key));
+
+        ++key;
+    }
+
+    CHECK(m->table.size == 4096 && m->rehash.ctrl);
+
+    size_t steps = 0;
+
+    while (m->rehash.ctrl){
+        CHECK(set_uint(m, key, key));
+
+        ++key;
+        ++steps;
+    }
+
+    /* 4096 old slots at MAP_REHASH_STEP a set */
+    CHECK(steps >= 4096 / 64 - 1);
+    CHECK(m->table.deleted == 0);
+
+    for (uint64_t index = 0; index < key; ++index){
+        CHECK(map_contains(m, sizeof(index), &index) == (index >= 1850));
+    }
+
+    map_free(m);
+
+    return true;
+}
+
+int main(void){
+    if (
+        !test_get_many_null() ||
+        !test_incremental_churn(M_PROBE_ROBIN_HOOD) ||
+        !test_incremental_churn(M_PROBE_GROUP) ||
+        !test_tombstone_rebuild()
+    ){
+        return EXIT_FAILURE;
+    }
+
+    puts("map ok");
+
+    return EXIT_SUCCESS;
+}
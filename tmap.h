@@ -0,0 +1,361 @@
+#ifndef TMAP_H
+#define TMAP_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * typed hash map. MAP_DECLARE(name, K, V, hash, equal) declares the
+ * type name and name_* functions for a map from K to V, both stored
+ * by value in the slots -- no type tags, sizes or per entry
+ * allocations, and every call inlines down to the key type. use map
+ * for mixed or JSON shaped data
+ *
+ *     MAP_DECLARE(counts, uint64_t, int64_t, tmap_hash_uint, tmap_equal_uint);
+ *
+ *     counts *c = counts_init();
+ *     counts_set(c, 42, 1);
+ *
+ * hash is called as uint64_t hash(K) and equal as bool equal(K, K),
+ * either can be a function or a macro. keys and values are copied as
+ * they are, so pointer keys (like strings) must outlive the map.
+ *
+ * linear probing with a control byte per slot holding 7 bits of the
+ * hash, so most mismatches are rejected without calling equal.
+ * removal shifts the following entries back instead of leaving
+ * tombstones. nothing is logged, failures are only reported by the
+ * return value. pointers from name_get are valid until the map is
+ * next modified
+ */
+
+#define TMAP_EMPTY -128
+#define TMAP_MINIMUM_SIZE 8
+
+/* resize when more than TMAP_LOAD_NUMERATOR / 8 of the slots are full */
+#define TMAP_LOAD_NUMERATOR 7
+
+static inline uint64_t tmap_hash_uint(uint64_t key){
+    /* murmur3 fmix64 -- the low bits pick the slot */
+    key ^= key >> 33;
+    key *= 0xFF51AFD7ED558CCDULL;
+    key ^= key >> 33;
+    key *= 0xC4CEB9FE1A85EC53ULL;
+    key ^= key >> 33;
+
+    return key;
+}
+
+static inline uint64_t tmap_hash_int(int64_t key){
+    return tmap_hash_uint((uint64_t)key);
+}
+
+/* fnv-1a, then mixed */
+static inline uint64_t tmap_hash_string(const char *key){
+    uint64_t hash = 0xCBF29CE484222325ULL;
+
+    for (; *key; ++key){
+        hash = (hash ^ (unsigned char)*key) * 0x100000001B3ULL;
+    }
+
+    return tmap_hash_uint(hash);
+}
+
+static inline bool tmap_equal_uint(uint64_t a, uint64_t b){
+    return a == b;
+}
+
+static inline bool tmap_equal_int(int64_t a, int64_t b){
+    return a == b;
+}
+
+static inline bool tmap_equal_string(const char *a, const char *b){
+    return a == b || !strcmp(a, b);
+}
+
+#define MAP_DECLARE(name, K, V, hash, equal) \
+    typedef struct name##_entry { \
+        K key; \
+        V value; \
+    } name##_entry; \
+    \
+    typedef struct name { \
+        int8_t *ctrl; \
+        name##_entry *entries; \
+        size_t length; \
+        size_t size; \
+    } name; \
+    \
+    static inline int8_t name##_tag(uint64_t h){ \
+        return (int8_t)(h >> 57); \
+    } \
+    \
+    /* slot of key or the empty slot it would go in */ \
+    static inline size_t name##_find(const name *m, K key, uint64_t h, bool *found){ \
+        size_t mask = m->size - 1; \
+        size_t slot = h & mask; \
+        int8_t tag = name##_tag(h); \
+        \
+        while (m->ctrl[slot] != TMAP_EMPTY){ \
+            if (m->ctrl[slot] == tag && equal(m->entries[slot].key, key)){ \
+                *found = true; \
+                \
+                return slot; \
+            } \
+            \
+            slot = (slot + 1) & mask; \
+        } \
+        \
+        *found = false; \
+        \
+        return slot; \
+    } \
+    \
+    static inline bool name##_table_init(name *m, size_t size){ \
+        m->ctrl = malloc(size); \
+        m->entries = malloc(size * sizeof(name##_entry)); \
+        \
+        if (!m->ctrl || !m->entries){ \
+            free(m->ctrl); \
+            free(m->entries); \
+            \
+            return false; \
+        } \
+        \
+        memset(m->ctrl, TMAP_EMPTY, size); \
+        \
+        m->size = size; \
+        \
+        return true; \
+    } \
+    \
+    static inline name *name##_init(void){ \
+        name *m = malloc(sizeof(*m)); \
+        \
+        if (!m){ \
+            return NULL; \
+        } \
+        \
+        if (!name##_table_init(m, TMAP_MINIMUM_SIZE)){ \
+            free(m); \
+            \
+            return NULL; \
+        } \
+        \
+        m->length = 0; \
+        \
+        return m; \
+    } \
+    \
+    /* makes room for length entries without another resize */ \
+    static inline bool name##_reserve(name *m, size_t length){ \
+        if (!m){ \
+            return false; \
+        } \
+        \
+        size_t size = m->size; \
+        \
+        while (length * 8 > size * TMAP_LOAD_NUMERATOR){ \
+            if (size > SIZE_MAX / 2 / sizeof(name##_entry)){ \
+                return false; \
+            } \
+            \
+            size *= 2; \
+        } \
+        \
+        if (size == m->size){ \
+            return true; \
+        } \
+        \
+        name old = *m; \
+        \
+        if (!name##_table_init(m, size)){ \
+            return false; \
+        } \
+        \
+        for (size_t slot = 0; slot < old.size; ++slot){ \
+            if (old.ctrl[slot] == TMAP_EMPTY){ \
+                continue; \
+            } \
+            \
+            uint64_t h = hash(old.entries[slot].key); \
+            size_t mask = m->size - 1; \
+            size_t position = h & mask; \
+            \
+            while (m->ctrl[position] != TMAP_EMPTY){ \
+                position = (position + 1) & mask; \
+            } \
+            \
+            m->ctrl[position] = old.ctrl[slot]; \
+            m->entries[position] = old.entries[slot]; \
+        } \
+        \
+        free(old.ctrl); \
+        free(old.entries); \
+        \
+        return true; \
+    } \
+    \
+    static inline name *name##_copy(const name *m){ \
+        if (!m){ \
+            return NULL; \
+        } \
+        \
+        name *copy = malloc(sizeof(*copy)); \
+        \
+        if (!copy){ \
+            return NULL; \
+        } \
+        \
+        if (!name##_table_init(copy, m->size)){ \
+            free(copy); \
+            \
+            return NULL; \
+        } \
+        \
+        memcpy(copy->ctrl, m->ctrl, m->size); \
+        memcpy(copy->entries, m->entries, m->size * sizeof(name##_entry)); \
+        \
+        copy->length = m->length; \
+        \
+        return copy; \
+    } \
+    \
+    static inline size_t name##_get_length(const name *m){ \
+        return m ? m->length : 0; \
+    } \
+    \
+    /* NULL when key is missing */ \
+    static inline V *name##_get(const name *m, K key){ \
+        if (!m){ \
+            return NULL; \
+        } \
+        \
+        bool found; \
+        size_t slot = name##_find(m, key, hash(key), &found); \
+        \
+        return found ? &m->entries[slot].value : NULL; \
+    } \
+    \
+    static inline bool name##_contains(const name *m, K key){ \
+        return name##_get(m, key) != NULL; \
+    } \
+    \
+    static inline bool name##_set(name *m, K key, V value){ \
+        if (!m){ \
+            return false; \
+        } \
+        \
+        uint64_t h = hash(key); \
+        bool found; \
+        size_t slot = name##_find(m, key, h, &found); \
+        \
+        if (!found){ \
+            if ((m->length + 1) * 8 > m->size * TMAP_LOAD_NUMERATOR){ \
+                if (!name##_reserve(m, m->length + 1)){ \
+                    return false; \
+                } \
+                \
+                slot = name##_find(m, key, h, &found); \
+            } \
+            \
+            m->ctrl[slot] = name##_tag(h); \
+            m->entries[slot].key = key; \
+            \
+            ++m->length; \
+        } \
+        \
+        m->entries[slot].value = value; \
+        \
+        return true; \
+    } \
+    \
+    /* value may be NULL, returns false when key is missing */ \
+    static inline bool name##_pop(name *m, K key, V *value){ \
+        if (!m){ \
+            return false; \
+        } \
+        \
+        bool found; \
+        size_t slot = name##_find(m, key, hash(key), &found); \
+        \
+        if (!found){ \
+            return false; \
+        } \
+        \
+        if (value){ \
+            *value = m->entries[slot].value; \
+        } \
+        \
+        /* backward shift -- pull later entries of the run into the hole if that's no further from home */ \
+        size_t mask = m->size - 1; \
+        size_t hole = slot; \
+        \
+        for (size_t next = (slot + 1) & mask; m->ctrl[next] != TMAP_EMPTY; next = (next + 1) & mask){ \
+            size_t home = hash(m->entries[next].key) & mask; \
+            \
+            if (((next - home) & mask) >= ((next - hole) & mask)){ \
+                m->ctrl[hole] = m->ctrl[next]; \
+                m->entries[hole] = m->entries[next]; \
+                \
+                hole = next; \
+            } \
+        } \
+        \
+        m->ctrl[hole] = TMAP_EMPTY; \
+        \
+        --m->length; \
+        \
+        return true; \
+    } \
+    \
+    static inline void name##_remove(name *m, K key){ \
+        name##_pop(m, key, NULL); \
+    } \
+    \
+    /* \
+     * walks the entries in slot order, start *position at 0. returns \
+     * NULL once done -- don't modify the map in between \
+     */ \
+    static inline name##_entry *name##_next(const name *m, size_t *position){ \
+        if (!m || !position){ \
+            return NULL; \
+        } \
+        \
+        while (*position < m->size){ \
+            size_t slot = (*position)++; \
+            \
+            if (m->ctrl[slot] != TMAP_EMPTY){ \
+                return m->entries + slot; \
+            } \
+        } \
+        \
+        return NULL; \
+    } \
+    \
+    static inline void name##_clear(name *m){ \
+        if (!m){ \
+            return; \
+        } \
+        \
+        memset(m->ctrl, TMAP_EMPTY, m->size); \
+        \
+        m->length = 0; \
+    } \
+    \
+    static inline void name##_free(name *m){ \
+        if (!m){ \
+            return; \
+        } \
+        \
+        free(m->ctrl); \
+        free(m->entries); \
+        free(m); \
+    } \
+    \
+    /* the caller's semicolon ends this declaration */ \
+    static inline void name##_free(name *)
+
+#endif
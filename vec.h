@@ -0,0 +1,196 @@
+#ifndef VEC_H
+#define VEC_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * typed growable array. VEC_DECLARE(name, T) declares the type name
+ * and name_* functions over a contiguous T array -- items are stored
+ * by value with no type tag or per item allocation. everything is
+ * static inline so it is generated where it is used. use list for
+ * mixed or JSON shaped data
+ *
+ *     VEC_DECLARE(doubles, double);
+ *
+ *     doubles *v = doubles_init();
+ *     doubles_push(v, 1.5);
+ *
+ * nothing is logged, failures are only reported by the return value.
+ * pointers from name_get are valid until the vector next grows
+ */
+
+#define VEC_MINIMUM_SIZE 8
+
+#define VEC_DECLARE(name, T) \
+    typedef struct name { \
+        T *items; \
+        size_t length; \
+        size_t size; \
+    } name; \
+    \
+    static inline name *name##_init(void){ \
+        name *v = malloc(sizeof(*v)); \
+        \
+        if (!v){ \
+            return NULL; \
+        } \
+        \
+        v->items = NULL; \
+        v->length = 0; \
+        v->size = 0; \
+        \
+        return v; \
+    } \
+    \
+    static inline bool name##_reserve(name *v, size_t size){ \
+        if (!v){ \
+            return false; \
+        } \
+        else if (size <= v->size){ \
+            return true; \
+        } \
+        else if (size > SIZE_MAX / sizeof(T)){ \
+            return false; \
+        } \
+        \
+        T *items = realloc(v->items, size * sizeof(T)); \
+        \
+        if (!items){ \
+            return false; \
+        } \
+        \
+        v->items = items; \
+        v->size = size; \
+        \
+        return true; \
+    } \
+    \
+    static inline name *name##_copy(const name *v){ \
+        if (!v){ \
+            return NULL; \
+        } \
+        \
+        name *copy = name##_init(); \
+        \
+        if (!copy){ \
+            return NULL; \
+        } \
+        \
+        if (!name##_reserve(copy, v->length)){ \
+            free(copy); \
+            \
+            return NULL; \
+        } \
+        \
+        if (v->length){ \
+            memcpy(copy->items, v->items, v->length * sizeof(T)); \
+        } \
+        \
+        copy->length = v->length; \
+        \
+        return copy; \
+    } \
+    \
+    static inline size_t name##_get_length(const name *v){ \
+        return v ? v->length : 0; \
+    } \
+    \
+    /* NULL when index is out of range */ \
+    static inline T *name##_get(const name *v, size_t index){ \
+        if (!v || index >= v->length){ \
+            return NULL; \
+        } \
+        \
+        return v->items + index; \
+    } \
+    \
+    static inline bool name##_set(name *v, size_t index, T item){ \
+        if (!v || index >= v->length){ \
+            return false; \
+        } \
+        \
+        v->items[index] = item; \
+        \
+        return true; \
+    } \
+    \
+    static inline bool name##_insert(name *v, size_t index, T item){ \
+        if (!v || index > v->length){ \
+            return false; \
+        } \
+        \
+        if (v->length == v->size && !name##_reserve(v, v->size ? v->size * 2 : VEC_MINIMUM_SIZE)){ \
+            return false; \
+        } \
+        \
+        memmove(v->items + index + 1, v->items + index, (v->length - index) * sizeof(T)); \
+        \
+        v->items[index] = item; \
+        \
+        ++v->length; \
+        \
+        return true; \
+    } \
+    \
+    static inline bool name##_push(name *v, T item){ \
+        if (!v){ \
+            return false; \
+        } \
+        \
+        if (v->length == v->size && !name##_reserve(v, v->size ? v->size * 2 : VEC_MINIMUM_SIZE)){ \
+            return false; \
+        } \
+        \
+        v->items[v->length++] = item; \
+        \
+        return true; \
+    } \
+    \
+    /* item may be NULL */ \
+    static inline bool name##_pop(name *v, T *item){ \
+        if (!v || !v->length){ \
+            return false; \
+        } \
+        \
+        --v->length; \
+        \
+        if (item){ \
+            *item = v->items[v->length]; \
+        } \
+        \
+        return true; \
+    } \
+    \
+    static inline void name##_remove(name *v, size_t index){ \
+        if (!v || index >= v->length){ \
+            return; \
+        } \
+        \
+        memmove(v->items + index, v->items + index + 1, (v->length - index - 1) * sizeof(T)); \
+        \
+        --v->length; \
+    } \
+    \
+    static inline void name##_clear(name *v){ \
+        if (v){ \
+            v->length = 0; \
+        } \
+    } \
+    \
+    static inline void name##_free(name *v){ \
+        if (!v){ \
+            return; \
+        } \
+        \
+        free(v->items); \
+        free(v); \
+    } \
+    \
+    /* the caller's semicolon ends this declaration */ \
+    static inline void name##_free(name *)
+
+#endif